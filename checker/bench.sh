@@ -0,0 +1,148 @@
+#!/bin/bash
+# Benchmark de scalabilitate pentru tema1_par, pe imagini sintetice generate cu gen_ppm.
+#
+# Pentru fiecare model si dimensiune se ruleaza o data varianta secventiala (./tema1), care da si
+# rezultatul de referinta, apoi tema1_par cu 1..THREADS thread-uri, de REPS ori fiecare. Fiecare
+# rulare este comparata cu referinta prin suma de control a imaginii de iesire (--checksum-only,
+# fara fisiere scrise) sau, cu VERIFY=cmp, octet cu octet, prin fisiere. Rezultatele se scriu in OUT (CSV), cate o
+# linie pe (model, dimensiune, thread-uri), cu mediana si minimul timpilor, accelerarea fata de
+# tema1_par cu un thread si fata de varianta secventiala, si eficienta.
+#
+# Variabile de mediu (cu valorile implicite):
+#   SIZES="512 1024 2048 4096 8192 16384 32768"  laturile imaginilor (o imagine de 32k ocupa 3 GB)
+#   PATTERNS="gradient noise shapes"              modelele generate
+#   THREADS=$(nproc)                              numarul maxim de thread-uri
+#   REPS=3                                        repetari pentru fiecare numar de thread-uri
+#   SEED=1                                        seed-ul imaginilor
+#   WORKDIR=bench_inputs                          directorul pentru imagini si rezultate
+#   OUT=bench.csv                                 fisierul CSV
+#   EXTRA_ARGS=""                                 optiuni suplimentare pentru tema1_par (ex. --tiled)
+#   VERIFY=checksum                               checksum (sume de control) sau cmp (fisiere)
+
+SIZES=${SIZES:-"512 1024 2048 4096 8192 16384 32768"}
+PATTERNS=${PATTERNS:-"gradient noise shapes"}
+THREADS=${THREADS:-$(nproc)}
+REPS=${REPS:-3}
+SEED=${SEED:-1}
+WORKDIR=${WORKDIR:-bench_inputs}
+OUT=${OUT:-bench.csv}
+EXTRA_ARGS=${EXTRA_ARGS:-""}
+VERIFY=${VERIFY:-checksum}
+
+if [ "$VERIFY" == "checksum" ]; then
+    VERIFY_ARGS="--checksum-only"
+elif [ "$VERIFY" == "cmp" ]; then
+    VERIFY_ARGS=""
+else
+    echo "E: VERIFY trebuie sa fie checksum sau cmp"
+    exit 1
+fi
+
+# timpul curent, in nanosecunde
+function now_ns {
+    date +%s%N
+}
+
+# ruleaza o comanda si afiseaza durata in milisecunde, cu 3 zecimale; iesirea standard a comenzii
+# (suma de control) ramane in $STDOUT_FILE (parametri: comanda...)
+function run_timed {
+    local start end
+    start=$(now_ns)
+    "$@" > "$STDOUT_FILE" 2> /dev/null || return 1
+    end=$(now_ns)
+    awk -v ns=$((end - start)) 'BEGIN { printf "%.3f", ns / 1000000 }'
+}
+
+# mediana unei liste de numere (parametri: numere...)
+function median {
+    printf "%s\n" "$@" | sort -n | awk '{ v[NR] = $1 } END { printf "%.3f", (NR % 2) ? v[(NR + 1) / 2] : (v[NR / 2] + v[NR / 2 + 1]) / 2 }'
+}
+
+# verifica rezultatul ultimei rulari: suma ei de control sau, cu VERIFY=cmp, fisierul ei
+# (parametri: fisier_referinta fisier_rezultat suma_referinta)
+function verify_result {
+    if [ "$VERIFY" == "checksum" ]; then
+        [ "$(cat "$STDOUT_FILE")" == "$3" ]
+    else
+        cmp -s "$1" "$2"
+    fi
+}
+
+# raportul a doua numere, cu 3 zecimale, sau 0 daca impartitorul este 0 (parametri: a b). Conditia
+# se calculeaza inainte de printf: in unele variante de awk un '>' din argumentele lui printf este
+# citit ca redirectare catre un fisier
+function ratio {
+    awk -v a="$1" -v b="$2" 'BEGIN { v = 0; if (b > 0) v = a / b; printf "%.3f", v }'
+}
+
+# minimul unei liste de numere (parametri: numere...)
+function minimum {
+    printf "%s\n" "$@" | sort -n | head -1
+}
+
+cd "$(dirname "$0")"
+
+# se compileaza ambele variante si generatorul
+make -C ../src build > /dev/null || { echo "E: Nu s-a putut compila tema1_par"; exit 1; }
+make build gen_ppm > /dev/null || { echo "E: Nu s-a putut compila tema1 / gen_ppm"; exit 1; }
+
+mkdir -p "$WORKDIR"
+# iesirea standard a rularilor se pastreaza intr-un fisier temporar, sters la iesire
+STDOUT_FILE=$(mktemp) || { echo "E: Nu s-a putut crea un fisier temporar"; exit 1; }
+trap 'rm -f "$STDOUT_FILE"' EXIT
+echo "pattern,size,threads,reps,median_ms,min_ms,seq_ms,speedup,speedup_vs_seq,efficiency,correct" > "$OUT"
+
+for pattern in $PATTERNS; do
+    for size in $SIZES; do
+        input="$WORKDIR/${pattern}_${size}.ppm"
+        ref="$WORKDIR/${pattern}_${size}_ref.ppm"
+        out="$WORKDIR/${pattern}_${size}_par.ppm"
+
+        if [ ! -f "$input" ]; then
+            echo "Se genereaza $input..."
+            ./gen_ppm "$pattern" "$size" "$size" "$SEED" "$input" || exit 1
+        fi
+
+        echo "== $pattern ${size}x${size} =="
+        seq_ms=$(run_timed ./tema1 "$input" "$ref" $VERIFY_ARGS)
+        if [ -z "$seq_ms" ]; then
+            echo "E: Varianta secventiala a esuat pe $input"
+            continue
+        fi
+        expected=$(cat "$STDOUT_FILE")
+        echo "secvential: ${seq_ms} ms"
+
+        base_ms=""
+        for P in $(seq 1 "$THREADS"); do
+            times=()
+            correct=1
+
+            for rep in $(seq 1 "$REPS"); do
+                rm -f "$out"
+                t=$(run_timed ../src/tema1_par "$input" "$out" "$P" $EXTRA_ARGS $VERIFY_ARGS)
+                if [ -z "$t" ] || ! verify_result "$ref" "$out" "$expected"; then
+                    correct=0
+                    echo "W: Rezultat gresit cu $P thread-uri (repetarea $rep)"
+                fi
+                times+=(${t:-0})
+            done
+
+            med=$(median "${times[@]}")
+            min=$(minimum "${times[@]}")
+            if [ -z "$base_ms" ]; then
+                base_ms=$med
+            fi
+
+            speedup=$(ratio "$base_ms" "$med")
+            speedup_seq=$(ratio "$seq_ms" "$med")
+            efficiency=$(awk -v s="$speedup" -v p="$P" 'BEGIN { printf "%.3f", s / p }')
+
+            echo "P=$P: mediana ${med} ms, minim ${min} ms, accelerare $speedup, eficienta $efficiency"
+            echo "$pattern,$size,$P,$REPS,$med,$min,$seq_ms,$speedup,$speedup_seq,$efficiency,$correct" >> "$OUT"
+        done
+
+        rm -f "$ref" "$out"
+    done
+done
+
+echo "Rezultatele sunt in $OUT"
@@ -0,0 +1,182 @@
+// Genereaza imagini PPM sintetice, deterministe, pentru bench.sh.
+// Imaginea este scrisa linie cu linie, deci si imaginile de 32k x 32k se genereaza cu memorie putina.
+//
+// Utilizare: ./gen_ppm <gradient|noise|shapes> <width> <height> <seed> <out_file>
+//   gradient - gradient diagonal cu ondulatii: contururi lungi, paralele
+//   noise    - zgomot interpolat: contururi dese in toata imaginea
+//   shapes   - cateva discuri inchise la culoare pe fundal alb: contururi rare
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define NOISE_CELL      64
+#define SHAPE_COUNT     12
+#define RIPPLE_PERIOD   256
+
+typedef struct {
+    long long cx, cy, r;
+} disc;
+
+/* @brief Generator xorshift64*, determinist pentru acelasi seed
+ * @param state starea generatorului
+ * @return urmatorul numar
+*/
+static uint64_t next_random(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1Dull;
+}
+
+/* @brief Valoarea pseudo-aleatoare (0-255) a unui nod din lattice-ul zgomotului
+ * @param x coloana nodului
+ * @param y linia nodului
+ * @param seed seed-ul imaginii
+ * @return valoarea nodului
+*/
+static int lattice(long long x, long long y, uint64_t seed) {
+    uint64_t h = seed ^ ((uint64_t)x * 0x9E3779B97F4A7C15ull) ^ ((uint64_t)y * 0xC2B2AE3D27D4EB4Full);
+
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    return (int)(h & 0xFF);
+}
+
+/* @brief O linie din gradient: valoarea creste pe diagonala, cu o unda triunghiulara peste ea
+ * @param row linia generata
+ * @param width latimea imaginii
+ * @param height inaltimea imaginii
+ * @param y indexul liniei
+ * @param ripple unda, pe o perioada
+*/
+static void gradient_row(unsigned char *row, int width, int height, int y, const int *ripple) {
+    for (int x = 0; x < width; x++) {
+        int v = (int)(((long long)x * height + (long long)y * width) * 191 / (2LL * width * height));
+
+        v += ripple[(x + 2 * y) % RIPPLE_PERIOD];
+        row[3 * x] = row[3 * x + 1] = row[3 * x + 2] = (unsigned char)(v < 0 ? 0 : v > 255 ? 255 : v);
+    }
+}
+
+/* @brief O linie din zgomot: lattice de NOISE_CELL pixeli interpolat biliniar, plus zgomot fin
+ * @param row linia generata
+ * @param width latimea imaginii
+ * @param y indexul liniei
+ * @param seed seed-ul imaginii
+ * @param state starea generatorului pentru zgomotul fin
+*/
+static void noise_row(unsigned char *row, int width, int y, uint64_t seed, uint64_t *state) {
+    long long cy = y / NOISE_CELL;
+    int fy = y % NOISE_CELL;
+
+    for (int x = 0; x < width; x++) {
+        long long cx = x / NOISE_CELL;
+        int fx = x % NOISE_CELL;
+
+        // interpolare biliniara intre nodurile celulei
+        int top = lattice(cx, cy, seed) * (NOISE_CELL - fx) + lattice(cx + 1, cy, seed) * fx;
+        int bottom = lattice(cx, cy + 1, seed) * (NOISE_CELL - fx) + lattice(cx + 1, cy + 1, seed) * fx;
+        int v = (top * (NOISE_CELL - fy) + bottom * fy) / (NOISE_CELL * NOISE_CELL);
+
+        // putin zgomot de frecventa inalta peste valoarea interpolata
+        v += (int)(next_random(state) & 15) - 8;
+        row[3 * x] = (unsigned char)(v < 0 ? 0 : v > 255 ? 255 : v);
+        row[3 * x + 1] = row[3 * x];
+        row[3 * x + 2] = (unsigned char)(255 - row[3 * x]);
+    }
+}
+
+/* @brief O linie din imaginea cu discuri
+ * @param row linia generata
+ * @param width latimea imaginii
+ * @param y indexul liniei
+ * @param discs discurile
+*/
+static void shapes_row(unsigned char *row, int width, int y, const disc *discs) {
+    memset(row, 255, 3 * (size_t)width);
+
+    // pentru fiecare disc care intersecteaza linia se umple intervalul de coloane acoperit
+    for (int i = 0; i < SHAPE_COUNT; i++) {
+        long long dy = y - discs[i].cy;
+        long long rest = discs[i].r * discs[i].r - dy * dy;
+        if (rest < 0) {
+            continue;
+        }
+
+        long long half = (long long)sqrt((double)rest);
+
+        long long start = discs[i].cx - half < 0 ? 0 : discs[i].cx - half;
+        long long end = discs[i].cx + half >= width ? width - 1 : discs[i].cx + half;
+        for (long long x = start; x <= end; x++) {
+            row[3 * x] = 40;
+            row[3 * x + 1] = 60;
+            row[3 * x + 2] = 90;
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 6) {
+        fprintf(stderr, "Usage: ./gen_ppm <gradient|noise|shapes> <width> <height> <seed> <out_file>\n");
+        return 1;
+    }
+
+    int width = atoi(argv[2]);
+    int height = atoi(argv[3]);
+    uint64_t seed = strtoull(argv[4], NULL, 10) * 0x9E3779B97F4A7C15ull + 1;
+    uint64_t state = seed;
+
+    if (width <= 0 || height <= 0) {
+        fprintf(stderr, "Invalid image size\n");
+        return 1;
+    }
+    if (strcmp(argv[1], "gradient") && strcmp(argv[1], "noise") && strcmp(argv[1], "shapes")) {
+        fprintf(stderr, "Unknown pattern '%s'\n", argv[1]);
+        return 1;
+    }
+
+    int ripple[RIPPLE_PERIOD];
+    for (int i = 0; i < RIPPLE_PERIOD; i++) {
+        // unda triunghiulara de amplitudine 32
+        int t = i < RIPPLE_PERIOD / 2 ? i : RIPPLE_PERIOD - i;
+        ripple[i] = t * 64 / RIPPLE_PERIOD * 2 - 32;
+    }
+
+    disc discs[SHAPE_COUNT];
+    long long min_side = width < height ? width : height;
+    for (int i = 0; i < SHAPE_COUNT; i++) {
+        discs[i].cx = next_random(&state) % width;
+        discs[i].cy = next_random(&state) % height;
+        discs[i].r = min_side / 40 + next_random(&state) % (min_side / 10 + 1);
+    }
+
+    unsigned char *row = malloc(3 * (size_t)width);
+    FILE *fp = fopen(argv[5], "wb");
+    if (!row || !fp) {
+        fprintf(stderr, "Unable to open file '%s'\n", argv[5]);
+        return 1;
+    }
+
+    fprintf(fp, "P6\n%d %d\n255\n", width, height);
+    for (int y = 0; y < height; y++) {
+        if (argv[1][0] == 'g') {
+            gradient_row(row, width, height, y, ripple);
+        } else if (argv[1][0] == 'n') {
+            noise_row(row, width, y, seed, &state);
+        } else {
+            shapes_row(row, width, y, discs);
+        }
+
+        if (fwrite(row, 3, width, fp) != (size_t)width) {
+            fprintf(stderr, "Error writing image '%s'\n", argv[5]);
+            return 1;
+        }
+    }
+
+    free(row);
+    return fclose(fp) ? 1 : 0;
+}
@@ -1,6 +1,7 @@
 // Author: APD team, except where source was noted
 
 #include "helpers.h"
+#include "../src/hash.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -189,11 +190,16 @@ ppm_image *rescale_image(ppm_image *image) {
 }
 
 int main(int argc, char *argv[]) {
-    if (argc < 3) {
-        fprintf(stderr, "Usage: ./tema1 <in_file> <out_file>\n");
+    if (argc < 3 || argc > 4 || (argc == 4 && strcmp(argv[3], "--checksum") && strcmp(argv[3], "--checksum-only"))) {
+        fprintf(stderr, "Usage: ./tema1 <in_file> <out_file> [--checksum|--checksum-only]\n");
         return 1;
     }
 
+    // suma de control este aceeasi ca la tema1_par --checksum, deci rezultatele se pot compara
+    // fara sa fie scrise pe disc
+    int checksum = argc == 4;
+    int write_output = !(argc == 4 && !strcmp(argv[3], "--checksum-only"));
+
     ppm_image *image = read_ppm(argv[1]);
     int step_x = STEP;
     int step_y = STEP;
@@ -211,7 +217,19 @@ int main(int argc, char *argv[]) {
     march(scaled_image, grid, contour_map, step_x, step_y);
 
     // 4. Write output
-    write_ppm(scaled_image, argv[2]);
+    if (checksum) {
+        uint64_t hash;
+        size_t size = (size_t)scaled_image->x * scaled_image->y * sizeof(ppm_pixel);
+
+        if (marching_hash_buffer(scaled_image->data, size, HASH_IMAGE_SEED(scaled_image->x, scaled_image->y), &hash)) {
+            fprintf(stderr, "Unable to allocate memory\n");
+            exit(1);
+        }
+        printf("%016llx\n", (unsigned long long)hash);
+    }
+    if (write_output) {
+        write_ppm(scaled_image, argv[2]);
+    }
 
     free_resources(scaled_image, contour_map, grid, step_x);
 
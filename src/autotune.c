@@ -0,0 +1,294 @@
+// Alegerea automata a numarului de thread-uri si a dimensiunii bucatilor de scalare.
+//
+// O calibrare, facuta o singura data pe masina si salvata intr-un fisier de profil, masoara pe un
+// singur thread costul per pixel al scalarii si al celorlalte faze, plus costul fiecarui thread
+// pornit (crearea, citirea contururilor, barierele unui job). Pentru o imagine, timpul estimat cu
+// n thread-uri este munca / n + n * costul unui thread; se alege n cu timpul minim, iar 0 (job-ul
+// pe thread-ul apelantului) cand nici doua thread-uri nu castiga.
+
+#include "marching_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define PROFILE_VERSION         1
+// imaginile folosite la calibrare
+#define CALIBRATE_RESCALE_ROWS  32
+#define CALIBRATE_MARCH_SIZE    1024
+#define CALIBRATE_TINY_SIZE     64
+#define CALIBRATE_RUNS          3
+// cel mult atatea thread-uri, indiferent de numarul de core-uri
+#define AUTOTUNE_MAX_THREADS    64
+// bucatile de scalare: cam atatea pe thread, dar fiecare de cel putin AUTOTUNE_CHUNK_US
+#define AUTOTUNE_CHUNKS         8
+#define AUTOTUNE_CHUNK_US       50
+
+/* @brief Umple o imagine cu inele concentrice, care dau contururi in toata imaginea
+ * @param img imaginea
+*/
+static void fillRings(ppm_image *img) {
+    for (int i = 0; i < img->x; i++) {
+        for (int j = 0; j < img->y; j++) {
+            ppm_pixel *px = &img->data[(size_t)i * img->y + j];
+            unsigned char v = (unsigned char)(((long long)i * i + (long long)j * j) >> 9);
+
+            px->red = px->green = v;
+            px->blue = (unsigned char)(255 - v);
+        }
+    }
+}
+
+/* @brief Aloca o imagine sintetica
+ * @param img imaginea
+ * @param x numarul de linii
+ * @param y numarul de coloane
+ * @param rows numarul de linii alocate (cel mult x)
+ * @return 0 la succes, -1 daca nu exista memorie
+*/
+static int allocImage(ppm_image *img, int x, int y, int rows) {
+    img->x = x;
+    img->y = y;
+    img->data = (ppm_pixel *)malloc((size_t)rows * y * sizeof(ppm_pixel));
+
+    return img->data ? 0 : -1;
+}
+
+/* @brief Costul scalarii pe un thread: primele CALIBRATE_RESCALE_ROWS linii ale unei imagini de
+ * iesire obisnuite, dintr-o sursa de 1.5 ori mai mare. Doar liniile calculate sunt alocate.
+ * @param ns ns per pixel scalat
+ * @return MARCHING_OK sau MARCHING_ERR_NOMEM
+*/
+static int measureRescale(double *ns) {
+    ppm_image source, out;
+
+    if (allocImage(&source, RESCALE_X * 3 / 2, RESCALE_Y * 3 / 2, RESCALE_X * 3 / 2)) {
+        return MARCHING_ERR_NOMEM;
+    }
+    if (allocImage(&out, RESCALE_X, RESCALE_Y, CALIBRATE_RESCALE_ROWS)) {
+        free(source.data);
+        return MARCHING_ERR_NOMEM;
+    }
+    fillRings(&source);
+
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < CALIBRATE_RUNS; r++) {
+        uint64_t start = marching_trace_now();
+        marching_rescale_rows(&source, NULL, MARCHING_RESAMPLE_BICUBIC, &out, 0, CALIBRATE_RESCALE_ROWS);
+        uint64_t elapsed = marching_trace_now() - start;
+
+        if (elapsed < best) {
+            best = elapsed;
+        }
+    }
+    *ns = (double)best / ((double)CALIBRATE_RESCALE_ROWS * RESCALE_Y);
+
+    free(source.data);
+    free(out.data);
+    return MARCHING_OK;
+}
+
+/* @brief Ruleaza un job complet, de la crearea contextului pana la distrugerea lui
+ * @param contours_dir directorul cu contururi
+ * @param P numarul de thread-uri
+ * @param in imaginea de intrare
+ * @param out imaginea de iesire
+ * @param ns durata, in ns
+ * @return MARCHING_OK sau un cod de eroare
+*/
+static int timeJob(const char *contours_dir, int P, const ppm_image *in, ppm_image *out, uint64_t *ns) {
+    marching_context *ctx;
+    uint64_t start = marching_trace_now();
+
+    int err = marching_create(&ctx, P, contours_dir);
+    if (err) {
+        return err;
+    }
+    err = marching_squares(ctx, in, out, NULL);
+    marching_destroy(ctx);
+
+    *ns = marching_trace_now() - start;
+    return err;
+}
+
+/* @brief Cel mai bun timp din CALIBRATE_RUNS rulari ale unui job complet
+ * @return MARCHING_OK sau un cod de eroare
+*/
+static int bestJob(const char *contours_dir, int P, const ppm_image *in, ppm_image *out, uint64_t *ns) {
+    *ns = UINT64_MAX;
+
+    for (int r = 0; r < CALIBRATE_RUNS; r++) {
+        uint64_t elapsed;
+        int err = timeJob(contours_dir, P, in, out, &elapsed);
+
+        if (err) {
+            return err;
+        }
+        if (elapsed < *ns) {
+            *ns = elapsed;
+        }
+    }
+
+    return MARCHING_OK;
+}
+
+/* @brief Costul fazelor fara scalare (copiere, grid, marcare) pe o imagine care nu este scalata
+ * si costul fiecarui thread pornit, ca diferenta intre un job minuscul cu thread-uri si unul fara
+ * @param contours_dir directorul cu contururi
+ * @param profile profilul completat (march_ns, thread_us)
+ * @return MARCHING_OK sau un cod de eroare
+*/
+static int measureJobs(const char *contours_dir, marching_profile *profile) {
+    ppm_image in, out, tiny, tiny_out;
+    uint64_t base = 0, march = 0, threaded = 0;
+    int n = profile->cores > 2 ? profile->cores : 2;
+    int err = MARCHING_ERR_NOMEM;
+
+    in.data = out.data = tiny.data = tiny_out.data = NULL;
+    if (!allocImage(&in, CALIBRATE_MARCH_SIZE, CALIBRATE_MARCH_SIZE, CALIBRATE_MARCH_SIZE) &&
+        !allocImage(&out, CALIBRATE_MARCH_SIZE, CALIBRATE_MARCH_SIZE, CALIBRATE_MARCH_SIZE) &&
+        !allocImage(&tiny, CALIBRATE_TINY_SIZE, CALIBRATE_TINY_SIZE, CALIBRATE_TINY_SIZE) &&
+        !allocImage(&tiny_out, CALIBRATE_TINY_SIZE, CALIBRATE_TINY_SIZE, CALIBRATE_TINY_SIZE)) {
+        fillRings(&in);
+        fillRings(&tiny);
+
+        err = bestJob(contours_dir, 0, &tiny, &tiny_out, &base);
+        if (!err) {
+            err = bestJob(contours_dir, 0, &in, &out, &march);
+        }
+        if (!err) {
+            err = bestJob(contours_dir, n, &tiny, &tiny_out, &threaded);
+        }
+    }
+
+    if (!err) {
+        // costul fix (crearea contextului, contururile) se scade din job-ul mare
+        double pixels = (double)CALIBRATE_MARCH_SIZE * CALIBRATE_MARCH_SIZE;
+        profile->march_ns = march > base ? (double)(march - base) / pixels : 0;
+        profile->thread_us = threaded > base ? (double)(threaded - base) / n / 1000 : 0;
+    }
+
+    free(in.data);
+    free(out.data);
+    free(tiny.data);
+    free(tiny_out.data);
+    return err;
+}
+
+/* @brief Citeste profilul dintr-un fisier
+ * @param path calea fisierului
+ * @param profile profilul citit
+ * @return 0 daca profilul este valid, -1 altfel
+*/
+static int readProfile(const char *path, marching_profile *profile) {
+    FILE *fp = fopen(path, "r");
+    int version;
+
+    if (!fp) {
+        return -1;
+    }
+
+    int ok = fscanf(fp, "marching-profile %d cores %d rescale_ns %lf march_ns %lf thread_us %lf", &version,
+                    &profile->cores, &profile->rescale_ns, &profile->march_ns, &profile->thread_us) == 5;
+    fclose(fp);
+
+    return ok && version == PROFILE_VERSION && profile->cores > 0 ? 0 : -1;
+}
+
+/* @brief Scrie profilul intr-un fisier
+ * @param path calea fisierului
+ * @param profile profilul
+ * @return 0 la succes, -1 la eroare
+*/
+static int writeProfile(const char *path, const marching_profile *profile) {
+    FILE *fp = fopen(path, "w");
+
+    if (!fp) {
+        return -1;
+    }
+
+    fprintf(fp, "marching-profile %d\ncores %d\nrescale_ns %.4f\nmarch_ns %.4f\nthread_us %.3f\n", PROFILE_VERSION,
+            profile->cores, profile->rescale_ns, profile->march_ns, profile->thread_us);
+
+    return fclose(fp) ? -1 : 0;
+}
+
+/* @brief Citeste profilul masinii din fisier sau, daca fisierul lipseste, este invalid ori a
+ * fost facut pe o masina cu alt numar de core-uri, face calibrarea si salveaza profilul.
+ * Calibrarea dureaza sub o secunda; o eroare la salvare nu este raportata.
+ * @param path calea fisierului de profil (NULL: profilul nu este salvat)
+ * @param contours_dir directorul cu contururi, folosit la calibrare (NULL inseamna ./contours)
+ * @param profile profilul
+ * @return MARCHING_OK sau un cod de eroare
+*/
+int marching_profile_load(const char *path, const char *contours_dir, marching_profile *profile) {
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (!profile) {
+        return MARCHING_ERR_ARGS;
+    }
+    if (cores <= 0) {
+        cores = 1;
+    }
+
+    if (path && !readProfile(path, profile) && profile->cores == cores) {
+        return MARCHING_OK;
+    }
+
+    memset(profile, 0, sizeof(marching_profile));
+    profile->cores = cores;
+
+    int err = measureRescale(&profile->rescale_ns);
+    if (!err) {
+        err = measureJobs(contours_dir, profile);
+    }
+    if (err) {
+        return err;
+    }
+
+    if (path) {
+        writeProfile(path, profile);
+    }
+
+    return MARCHING_OK;
+}
+
+/* @brief Alege numarul de thread-uri si dimensiunea bucatilor de scalare pentru o imagine
+ * @param profile profilul masinii
+ * @param in imaginea de intrare
+ * @param P numarul de thread-uri (0: job-ul ruleaza pe thread-ul apelantului)
+ * @param chunk liniile unei bucati de scalare (0: o banda egala pe thread)
+*/
+void marching_autotune(const marching_profile *profile, const ppm_image *in, int *P, int *chunk) {
+    int x, y;
+
+    *P = 0;
+    *chunk = 0;
+    if (!profile || marching_output_size(in, &x, &y)) {
+        return;
+    }
+
+    int rescale = !(in->x <= RESCALE_X && in->y <= RESCALE_Y);
+    double pixels = (double)x * y;
+    double work = pixels * profile->march_ns + (rescale ? pixels * profile->rescale_ns : 0);
+    double best = work;
+    int max_threads = min(profile->cores, AUTOTUNE_MAX_THREADS);
+
+    // cu un singur thread munca este aceeasi ca fara thread-uri, dar costa pornirea lui
+    for (int n = 2; n <= max_threads; n++) {
+        double estimate = work / n + n * profile->thread_us * 1000;
+
+        if (estimate < best) {
+            best = estimate;
+            *P = n;
+        }
+    }
+
+    if (*P && rescale) {
+        int rows = (x + *P * AUTOTUNE_CHUNKS - 1) / (*P * AUTOTUNE_CHUNKS);
+        double row_ns = y * profile->rescale_ns;
+        int min_rows = row_ns > 0 ? (int)(AUTOTUNE_CHUNK_US * 1000 / row_ns) + 1 : 1;
+
+        *chunk = min(rows > min_rows ? rows : min_rows, x);
+    }
+}
@@ -0,0 +1,331 @@
+#include "cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define CACHE_PATH_SIZE         4096
+#define CACHE_HEADER_SIZE       64
+
+typedef struct {
+    char name[256];
+    struct timespec mtime;
+    uint64_t size;
+} cache_file;
+
+/* @brief Construieste calea unui fisier din cache
+ * @param path calea
+ * @param dir directorul cache-ului
+ * @param key cheia intrarii
+ * @param sigma pragul, pentru grid-uri, sau -1 pentru imagini
+ * @return 0 la succes, -1 daca calea este prea lunga
+*/
+static int entryPath(char *path, const char *dir, uint64_t key, int sigma) {
+    int len = sigma < 0 ? snprintf(path, CACHE_PATH_SIZE, "%s/%016llx.ppm", dir, (unsigned long long)key)
+                        : snprintf(path, CACHE_PATH_SIZE, "%s/%016llx-s%d.grid", dir, (unsigned long long)key, sigma);
+
+    return len < 0 || len >= CACHE_PATH_SIZE ? -1 : 0;
+}
+
+/* @brief Mapeaza o intrare si verifica antetul si dimensiunea ei. Intrarea gasita devine cea
+ * mai recent folosita.
+ * @param path calea fisierului
+ * @param header antetul asteptat
+ * @param size dimensiunea continutului de dupa antet
+ * @param entry intrarea mapata
+ * @return 1 daca intrarea a fost gasita, 0 altfel
+*/
+static int mapEntry(const char *path, const char *header, size_t size, cache_entry *entry) {
+    size_t header_size = strlen(header);
+    struct stat st;
+
+    entry->map = NULL;
+    entry->size = 0;
+    entry->data = NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    if (fstat(fd, &st) || (uint64_t)st.st_size != header_size + size) {
+        close(fd);
+        return 0;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return 0;
+    }
+    if (memcmp(map, header, header_size)) {
+        munmap(map, st.st_size);
+        return 0;
+    }
+
+    // timpul de modificare este ordinea folosita la stergere
+    utimensat(AT_FDCWD, path, NULL, 0);
+
+    entry->map = map;
+    entry->size = st.st_size;
+    entry->data = (const unsigned char *)map + header_size;
+    return 1;
+}
+
+/* @brief Creeaza directorul cache-ului si directoarele parinte care lipsesc
+ * @param dir directorul cache-ului
+ * @return 0 daca directorul exista sau a fost creat, -1 altfel
+*/
+static int createDir(const char *dir) {
+    char path[CACHE_PATH_SIZE];
+    int len = snprintf(path, sizeof(path), "%s", dir);
+
+    if (len <= 0 || len >= CACHE_PATH_SIZE) {
+        return -1;
+    }
+
+    // fiecare prefix terminat cu '/', apoi calea completa
+    for (int i = 1; i <= len; i++) {
+        if (path[i] != '/' && path[i] != '\0') {
+            continue;
+        }
+
+        char c = path[i];
+        path[i] = '\0';
+        if (mkdir(path, 0755) && errno != EEXIST) {
+            return -1;
+        }
+        path[i] = c;
+    }
+
+    struct stat st;
+    return stat(dir, &st) || !S_ISDIR(st.st_mode) ? -1 : 0;
+}
+
+/* @brief Scrie o intrare intr-un fisier temporar si il redenumeste, ca o intrare citita
+ * simultan de alt proces sa fie completa. Numele fisierului temporar este unic (mkstemp), deci
+ * si contextele din acelasi proces pot scrie simultan aceeasi intrare.
+ * @param path calea intrarii
+ * @param header antetul
+ * @param rows liniile continutului
+ * @param count numarul de linii
+ * @param size dimensiunea unei linii
+ * @return 0 la succes, -1 la eroare
+*/
+static int writeEntry(const char *path, const char *header, const void *const *rows, int count, size_t size) {
+    char tmp[CACHE_PATH_SIZE + 32];
+    snprintf(tmp, sizeof(tmp), "%s.tmp.XXXXXX", path);
+
+    int fd = mkstemp(tmp);
+    if (fd < 0) {
+        return -1;
+    }
+
+    // mkstemp creeaza fisierul doar pentru proprietar; intrarile pot fi citite si de alti utilizatori
+    FILE *fp = fchmod(fd, 0644) ? NULL : fdopen(fd, "wb");
+    if (!fp) {
+        close(fd);
+        unlink(tmp);
+        return -1;
+    }
+
+    int err = fputs(header, fp) < 0;
+    for (int i = 0; i < count && !err; i++) {
+        err = fwrite(rows[i], 1, size, fp) != size;
+    }
+    if (fclose(fp) || err || rename(tmp, path)) {
+        unlink(tmp);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* @brief Cauta imaginea scalata a unei chei
+ * @param dir directorul cache-ului
+ * @param key cheia
+ * @param x latimea asteptata
+ * @param y inaltimea asteptata
+ * @param entry intrarea mapata; pixelii incep la entry->data
+ * @return 1 daca imaginea a fost gasita, 0 altfel
+*/
+int marching_cache_lookup_image(const char *dir, uint64_t key, int x, int y, cache_entry *entry) {
+    char path[CACHE_PATH_SIZE];
+    char header[CACHE_HEADER_SIZE];
+
+    entry->map = NULL;
+    if (entryPath(path, dir, key, -1)) {
+        return 0;
+    }
+    snprintf(header, sizeof(header), "P6\n%d %d\n%d\n", x, y, RGB_COMPONENT_COLOR);
+
+    return mapEntry(path, header, (size_t)x * y * sizeof(ppm_pixel), entry);
+}
+
+/* @brief Cauta grid-ul unei chei, calculat cu pragul sigma
+ * @param dir directorul cache-ului
+ * @param key cheia
+ * @param sigma pragul
+ * @param p numarul de linii de celule
+ * @param q numarul de coloane de celule
+ * @param entry intrarea mapata; cele (p + 1) x (q + 1) puncte incep la entry->data
+ * @return 1 daca grid-ul a fost gasit, 0 altfel
+*/
+int marching_cache_lookup_grid(const char *dir, uint64_t key, int sigma, int p, int q, cache_entry *entry) {
+    char path[CACHE_PATH_SIZE];
+    char header[CACHE_HEADER_SIZE];
+
+    entry->map = NULL;
+    if (entryPath(path, dir, key, sigma)) {
+        return 0;
+    }
+    snprintf(header, sizeof(header), "GRID\n%d %d\n%d\n", p, q, sigma);
+
+    return mapEntry(path, header, (size_t)(p + 1) * (q + 1), entry);
+}
+
+/* @brief Salveaza imaginea scalata a unei chei
+ * @param dir directorul cache-ului
+ * @param key cheia
+ * @param img imaginea
+ * @return 0 la succes, -1 la eroare
+*/
+int marching_cache_store_image(const char *dir, uint64_t key, const ppm_image *img) {
+    char path[CACHE_PATH_SIZE];
+    char header[CACHE_HEADER_SIZE];
+
+    if (entryPath(path, dir, key, -1) || createDir(dir)) {
+        return -1;
+    }
+    snprintf(header, sizeof(header), "P6\n%d %d\n%d\n", img->x, img->y, RGB_COMPONENT_COLOR);
+
+    const void *data = img->data;
+    return writeEntry(path, header, &data, 1, (size_t)img->x * img->y * sizeof(ppm_pixel));
+}
+
+/* @brief Salveaza grid-ul unei chei
+ * @param dir directorul cache-ului
+ * @param key cheia
+ * @param sigma pragul cu care a fost calculat
+ * @param p numarul de linii de celule
+ * @param q numarul de coloane de celule
+ * @param grid liniile grid-ului, (p + 1) x (q + 1) puncte; in fisier sunt consecutive
+ * @return 0 la succes, -1 la eroare
+*/
+int marching_cache_store_grid(const char *dir, uint64_t key, int sigma, int p, int q, unsigned char **grid) {
+    char path[CACHE_PATH_SIZE];
+    char header[CACHE_HEADER_SIZE];
+
+    if (entryPath(path, dir, key, sigma) || createDir(dir)) {
+        return -1;
+    }
+    snprintf(header, sizeof(header), "GRID\n%d %d\n%d\n", p, q, sigma);
+
+    return writeEntry(path, header, (const void *const *)grid, p + 1, (size_t)q + 1);
+}
+
+/* @brief Elibereaza maparea unei intrari
+ * @param entry intrarea
+*/
+void marching_cache_release(cache_entry *entry) {
+    if (entry->map) {
+        munmap(entry->map, entry->size);
+    }
+    entry->map = NULL;
+    entry->size = 0;
+    entry->data = NULL;
+}
+
+/* @brief Verifica daca un fisier din director este o intrare a cache-ului
+ * @param name numele fisierului
+ * @return 1 pentru intrari, 0 pentru alte fisiere (inclusiv cele temporare)
+*/
+static int isEntry(const char *name) {
+    size_t len = strlen(name);
+
+    if (len < 16 || strspn(name, "0123456789abcdef") != 16) {
+        return 0;
+    }
+    return !strcmp(name + 16, ".ppm") || (name[16] == '-' && len > 5 && !strcmp(name + len - 5, ".grid"));
+}
+
+static int compareFiles(const void *a, const void *b) {
+    const cache_file *fa = (const cache_file *)a;
+    const cache_file *fb = (const cache_file *)b;
+
+    if (fa->mtime.tv_sec != fb->mtime.tv_sec) {
+        return fa->mtime.tv_sec < fb->mtime.tv_sec ? -1 : 1;
+    }
+    return fa->mtime.tv_nsec < fb->mtime.tv_nsec ? -1 : fa->mtime.tv_nsec > fb->mtime.tv_nsec;
+}
+
+/* @brief Sterge intrarile cel mai putin recent folosite pana cand dimensiunea totala a
+ * intrarilor nu depaseste limita. Alte fisiere din director nu sunt atinse.
+ * @param dir directorul cache-ului
+ * @param limit dimensiunea maxima, in octeti (0: fara limita)
+*/
+void marching_cache_evict(const char *dir, uint64_t limit) {
+    if (!limit) {
+        return;
+    }
+
+    DIR *d = opendir(dir);
+    if (!d) {
+        return;
+    }
+
+    cache_file *files = NULL;
+    size_t count = 0, capacity = 0;
+    uint64_t total = 0;
+    struct dirent *de;
+
+    while ((de = readdir(d))) {
+        char path[CACHE_PATH_SIZE];
+        struct stat st;
+
+        if (!isEntry(de->d_name) || strlen(de->d_name) >= sizeof(files->name)) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+        if (stat(path, &st) || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+
+        if (count == capacity) {
+            size_t new_capacity = capacity ? 2 * capacity : 64;
+            cache_file *new_files = realloc(files, new_capacity * sizeof(cache_file));
+            if (!new_files) {
+                break;
+            }
+            files = new_files;
+            capacity = new_capacity;
+        }
+
+        strcpy(files[count].name, de->d_name);
+        files[count].mtime = st.st_mtim;
+        files[count].size = st.st_size;
+        total += st.st_size;
+        count++;
+    }
+    closedir(d);
+
+    if (count) {
+        qsort(files, count, sizeof(cache_file), compareFiles);
+    }
+
+    for (size_t i = 0; i < count && total > limit; i++) {
+        char path[CACHE_PATH_SIZE];
+
+        snprintf(path, sizeof(path), "%s/%s", dir, files[i].name);
+        if (!unlink(path) || errno == ENOENT) {
+            total -= files[i].size;
+        }
+    }
+
+    free(files);
+}
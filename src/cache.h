@@ -0,0 +1,30 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+// Cache pe disc pentru imaginile scalate si grid-uri (--cache-dir). O intrare este un fisier
+// al carui nume este cheia (hash-ul imaginii de intrare si al parametrilor scalarii):
+//   <cheie>.ppm           imaginea scalata, in format P6
+//   <cheie>-s<sigma>.grid grid-ul calculat cu pragul sigma
+// Fisierele se scriu intr-un fisier temporar redenumit apoi, deci o intrare este completa sau
+// lipseste. La o gasire fisierul este mapat in memorie si timpul lui de modificare este
+// actualizat; la depasirea dimensiunii maxime se sterg intrarile cele mai vechi (LRU).
+
+#include "helpers.h"
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    void *map;
+    size_t size;
+    // continutul de dupa antet
+    const unsigned char *data;
+} cache_entry;
+
+int marching_cache_lookup_image(const char *dir, uint64_t key, int x, int y, cache_entry *entry);
+int marching_cache_lookup_grid(const char *dir, uint64_t key, int sigma, int p, int q, cache_entry *entry);
+int marching_cache_store_image(const char *dir, uint64_t key, const ppm_image *img);
+int marching_cache_store_grid(const char *dir, uint64_t key, int sigma, int p, int q, unsigned char **grid);
+void marching_cache_release(cache_entry *entry);
+void marching_cache_evict(const char *dir, uint64_t limit);
+
+#endif
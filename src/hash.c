@@ -0,0 +1,155 @@
+#include "hash.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define PRIME64_1               0x9E3779B185EBCA87ull
+#define PRIME64_2               0xC2B2AE3D27D4EB4Full
+#define PRIME64_3               0x165667B19E3779F9ull
+#define PRIME64_4               0x85EBCA77C2B2AE63ull
+#define PRIME64_5               0x27D4EB2F165667C5ull
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// citirile sunt little endian, ca in XXH64 pe x86 / ARM
+static inline uint64_t read64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t read32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t round64(uint64_t acc, uint64_t input) {
+    acc += input * PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * PRIME64_1;
+}
+
+static inline uint64_t mergeRound(uint64_t acc, uint64_t val) {
+    acc ^= round64(0, val);
+    return acc * PRIME64_1 + PRIME64_4;
+}
+
+/* @brief Hash-ul XXH64 al unui buffer
+ * @param data buffer-ul
+ * @param size dimensiunea, in octeti
+ * @param seed valoarea initiala
+ * @return hash-ul
+*/
+uint64_t marching_hash64(const void *data, size_t size, uint64_t seed) {
+    const unsigned char *p = (const unsigned char *)data;
+    const unsigned char *end = p + size;
+    uint64_t h;
+
+    if (size >= 32) {
+        // patru acumulatori independenti, cate 8 octeti fiecare pe runda
+        const unsigned char *limit = end - 32;
+        uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+        uint64_t v2 = seed + PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME64_1;
+
+        do {
+            v1 = round64(v1, read64(p));
+            v2 = round64(v2, read64(p + 8));
+            v3 = round64(v3, read64(p + 16));
+            v4 = round64(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    } else {
+        h = seed + PRIME64_5;
+    }
+
+    h += size;
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= round64(0, read64(p));
+        h = rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+    }
+    if (p + 4 <= end) {
+        h ^= (uint64_t)read32(p) * PRIME64_1;
+        h = rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= *p * PRIME64_5;
+        h = rotl64(h, 11) * PRIME64_1;
+    }
+
+    // avalanche
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+/* @brief Numarul de blocuri in care se imparte un buffer
+ * @param size dimensiunea buffer-ului
+ * @return numarul de blocuri (cel putin 1)
+*/
+size_t marching_hash_block_count(size_t size) {
+    return size ? (size + HASH_BLOCK_SIZE - 1) / HASH_BLOCK_SIZE : 1;
+}
+
+/* @brief Hash-ul unui bloc dintr-un buffer; ultimul bloc poate fi mai scurt
+ * @param data buffer-ul intreg
+ * @param size dimensiunea buffer-ului
+ * @param block indexul blocului
+ * @return hash-ul blocului
+*/
+uint64_t marching_hash_block(const void *data, size_t size, size_t block) {
+    size_t start = block * HASH_BLOCK_SIZE;
+    size_t len = size - start < HASH_BLOCK_SIZE ? size - start : HASH_BLOCK_SIZE;
+
+    return marching_hash64((const unsigned char *)data + start, len, 0);
+}
+
+/* @brief Combina hash-urile blocurilor, in ordine, intr-un singur hash
+ * @param blocks hash-urile blocurilor
+ * @param count numarul de blocuri
+ * @param seed valoarea initiala
+ * @return hash-ul intregului buffer
+*/
+uint64_t marching_hash_combine(const uint64_t *blocks, size_t count, uint64_t seed) {
+    return marching_hash64(blocks, count * sizeof(uint64_t), seed);
+}
+
+/* @brief Hash-ul unui buffer intreg, calculat pe un singur thread; rezultatul este acelasi ca
+ * la hash-urile blocurilor (marching_hash_block) combinate cu marching_hash_combine
+ * @param data buffer-ul
+ * @param size dimensiunea buffer-ului
+ * @param seed valoarea initiala pentru combinare
+ * @param hash hash-ul calculat
+ * @return 0 la succes, -1 daca nu exista memorie
+*/
+int marching_hash_buffer(const void *data, size_t size, uint64_t seed, uint64_t *hash) {
+    size_t count = marching_hash_block_count(size);
+    uint64_t *blocks = (uint64_t *)malloc(count * sizeof(uint64_t));
+
+    if (!blocks) {
+        return -1;
+    }
+
+    for (size_t b = 0; b < count; b++) {
+        blocks[b] = marching_hash_block(data, size, b);
+    }
+    *hash = marching_hash_combine(blocks, count, seed);
+
+    free(blocks);
+    return 0;
+}
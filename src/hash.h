@@ -0,0 +1,24 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Hash rapid, necriptografic (algoritmul XXH64), pentru identificarea continutului imaginilor.
+// Imaginile mari se impart in blocuri de HASH_BLOCK_SIZE octeti, hash-uite independent (deci in
+// paralel), iar hash-urile blocurilor se combina in ordine. Rezultatul nu depinde de numarul de
+// thread-uri.
+#define HASH_BLOCK_SIZE         (1 << 20)
+
+// Suma de control a pixelilor unei imagini de x * y pixeli (--checksum): hash-urile blocurilor
+// combinate cu un seed care contine dimensiunile, deci doua imagini cu aceiasi octeti dar alte
+// dimensiuni au sume diferite
+#define HASH_IMAGE_SEED(x, y)   (((uint64_t)(uint32_t)(x) << 32) | (uint32_t)(y))
+
+uint64_t marching_hash64(const void *data, size_t size, uint64_t seed);
+size_t marching_hash_block_count(size_t size);
+uint64_t marching_hash_block(const void *data, size_t size, size_t block);
+uint64_t marching_hash_combine(const uint64_t *blocks, size_t count, uint64_t seed);
+int marching_hash_buffer(const void *data, size_t size, uint64_t seed, uint64_t *hash);
+
+#endif
@@ -0,0 +1,2044 @@
+#include "marching_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+#define CLAMP(v, min, max) if(v < min) { v = min; } else if(v > max) { v = max; }
+
+// Updates a particular section of an image with the corresponding contour pixels.
+// Used to create the complete contour image.
+/* @brief Actualizeaza o anumita sectiune a imaginii cu pixelii corespunzatori conturului
+ * @param image imaginea
+ * @param contour conturul
+ * @param x coordonata x
+ * @param y coordonata y
+*/
+static void update_image(ppm_image *image, ppm_image *contour, int x, int y) {
+    for (int i = 0; i < contour->x; i++) {
+        for (int j = 0; j < contour->y; j++) {
+            int contour_pixel_index = contour->x * i + j;
+            int image_pixel_index = (x + i) * image->y + y + j;
+
+            image->data[image_pixel_index].red = contour->data[contour_pixel_index].red;
+            image->data[image_pixel_index].green = contour->data[contour_pixel_index].green;
+            image->data[image_pixel_index].blue = contour->data[contour_pixel_index].blue;
+        }
+    }
+}
+
+/*@brief Citeste contururile din directorul contextului
+ * @param informatii utile folosite de thread-ul curent
+*/
+static void contur(thread_structure *thread) {
+    int start = thread->id * (double)CONTOUR_CONFIG_COUNT / thread->noThreads;
+    int end = min((thread->id + 1) * (double)CONTOUR_CONFIG_COUNT / thread->noThreads, CONTOUR_CONFIG_COUNT);
+
+    for (int i = start; i < end; i++) {
+        char filename[PATH_MAX_SIZE];
+        snprintf(filename, sizeof(filename), "%s/%d.ppm", thread->ctx->contours_dir, i);
+
+        thread->contur[i] = (ppm_image *)calloc(1, sizeof(ppm_image));
+        if (!thread->contur[i]) {
+            thread->error = MARCHING_ERR_NOMEM;
+            return;
+        }
+
+        int err = marching_load_ppm(filename, thread->contur[i]);
+        if (err) {
+            thread->error = err;
+            return;
+        }
+    }
+}
+
+/* @brief Copiaza imaginea de intrare in imaginea de iesire, cand nu este nevoie de scalare.
+ * Fiecare thread copiaza o banda de linii.
+ * @param thread informatii utile folosite de thread-ul curent
+*/
+static void copyImage(thread_structure *thread) {
+    int start = thread->id * (double)thread->image->y / thread->noThreads;
+    int end = min((thread->id + 1) * (double)thread->image->y / thread->noThreads, thread->image->y);
+    size_t row = (size_t)thread->image->x;
+    thread->chunk_start = start;
+    thread->chunk_end = end;
+
+    memcpy(&thread->scaled_image->data[row * start], &thread->image->data[row * start],
+           row * (end - start) * sizeof(ppm_pixel));
+}
+
+/* @brief Rearanjeaza imaginea sursa pe tile-uri. Fiecare thread copiaza o banda de linii de tile-uri.
+ * @param thread informatii utile folosite de thread-ul curent
+*/
+static void repackImage(thread_structure *thread) {
+    int tiles_y = thread->tiled_image->tiles_y;
+    int start = thread->id * (double)tiles_y / thread->noThreads;
+    int end = min((thread->id + 1) * (double)tiles_y / thread->noThreads, tiles_y);
+    thread->chunk_start = start;
+    thread->chunk_end = end;
+
+    marching_repack_tiles(thread->source, thread->tiled_image, start, end);
+}
+
+/* @brief Calculeaza pixelul (i, j) al imaginii scalate, cu nucleul de esantionare ales
+ * @param source imaginea sursa
+ * @param tiled imaginea sursa pe tile-uri sau NULL (doar pentru interpolarea bicubica)
+ * @param resample nucleul (MARCHING_RESAMPLE_*)
+ * @param x numarul de linii al imaginii scalate
+ * @param y numarul de coloane al imaginii scalate
+ * @param i linia
+ * @param j coloana
+ * @param sample culoarea calculata
+*/
+void marching_rescale_pixel(const ppm_image *source, tiled_image *tiled, int resample, int x, int y, int i, int j,
+                            uint8_t sample[]) {
+    float u = (float)i / (float)(x - 1);
+    float v = (float)j / (float)(y - 1);
+
+    switch (resample) {
+    case MARCHING_RESAMPLE_BILINEAR:
+        marching_sample_bilinear(source, u, v, sample);
+        break;
+    case MARCHING_RESAMPLE_NEAREST:
+        marching_sample_nearest(source, u, v, sample);
+        break;
+    case MARCHING_RESAMPLE_AREA:
+        // u si v merg pe source->x, respectiv source->y, deci si pixelul de iesire
+        marching_sample_area(source, u, v, (float)source->x / x, (float)source->y / y, sample);
+        break;
+    default:
+        if (tiled) {
+            marching_sample_bicubic_tiled(tiled, u, v, sample);
+        } else {
+            marching_sample_bicubic(source, u, v, sample);
+        }
+        break;
+    }
+}
+
+/* @brief Scaleaza liniile [start, end) ale imaginii de iesire
+ * @param source imaginea sursa
+ * @param tiled imaginea sursa pe tile-uri sau NULL
+ * @param resample nucleul de esantionare (MARCHING_RESAMPLE_*)
+ * @param out imaginea scalata
+ * @param start prima linie
+ * @param end linia de dupa ultima
+*/
+void marching_rescale_rows(const ppm_image *source, tiled_image *tiled, int resample, ppm_image *out, int start, int end) {
+    uint8_t sample[3];
+
+    for (int i = start; i < end; i++) {
+        for (int j = 0; j < out->y; j++) {
+            marching_rescale_pixel(source, tiled, resample, out->x, out->y, i, j, sample);
+
+            out->data[i * out->y + j].red = sample[0];
+            out->data[i * out->y + j].green = sample[1];
+            out->data[i * out->y + j].blue = sample[2];
+        }
+    }
+}
+
+/* @brief Calculeaza un punct din grid direct din imaginea de intrare, fara imaginea scalata,
+ * cu aceeasi valoare pe care createGrid ar citi-o din imaginea scalata
+ * @param in imaginea de intrare
+ * @param resample nucleul de esantionare (MARCHING_RESAMPLE_*)
+ * @param x numarul de linii al imaginii scalate
+ * @param y numarul de coloane al imaginii scalate
+ * @param i linia punctului
+ * @param j coloana punctului
+ * @return 0 daca punctul este peste prag, 1 altfel
+*/
+unsigned char marching_grid_point(const ppm_image *in, int resample, int x, int y, int i, int j) {
+    int p = x / STEP;
+    int q = y / STEP;
+
+    // coltul nu este calculat de createGrid (nici in varianta secventiala)
+    if (i == p && j == q) {
+        return 0;
+    }
+
+    // acelasi index ca in createGrid, inclusiv pentru ultima linie / coloana
+    size_t index = (i < p ? (size_t)i * STEP * y : (size_t)(x - 1) * y) + (j < q ? (size_t)j * STEP : (size_t)x - 1);
+
+    ppm_pixel pixel;
+    if (!(in->x <= RESCALE_X && in->y <= RESCALE_Y)) {
+        uint8_t sample[3];
+
+        marching_rescale_pixel(in, NULL, resample, x, y, index / y, index % y, sample);
+        pixel.red = sample[0];
+        pixel.green = sample[1];
+        pixel.blue = sample[2];
+    } else {
+        pixel = in->data[index];
+    }
+
+    unsigned char curr_color = (pixel.red + pixel.green + pixel.blue) / 3;
+
+    return curr_color > SIGMA ? 0 : 1;
+}
+
+/* @brief Scaleaza imaginea pe bucati de opts->rescale_chunk linii, luate pe rand de thread-uri
+ * dintr-un contor comun; un thread mai lent ia mai putine bucati.
+ * @param thread informatii utile folosite de thread-ul curent
+*/
+static void rescaleChunks(thread_structure *thread) {
+    marching_context *ctx = thread->ctx;
+    ppm_image *out = thread->scaled_image;
+    int chunk = thread->opts->rescale_chunk;
+
+    // liniile unui thread nu mai sunt un singur interval
+    thread->chunk_start = thread->chunk_end = -1;
+
+    while (1) {
+        pthread_mutex_lock(&ctx->pipeline_lock);
+        int start = ctx->next_row;
+        ctx->next_row = min(start + chunk, out->x);
+        pthread_mutex_unlock(&ctx->pipeline_lock);
+
+        if (start >= out->x) {
+            break;
+        }
+        marching_rescale_rows(thread->source, thread->tiled_image, thread->opts->resample, out, start, min(start + chunk, out->x));
+    }
+}
+
+/* @brief Scaleaza imaginea folosind interpolare bicubica
+ * @param thread informatii utile folosite de thread-ul curent
+*/
+static void rescaleImage(thread_structure *thread) {
+    if (thread->opts->rescale_chunk > 0) {
+        rescaleChunks(thread);
+        return;
+    }
+
+    // Se imparte imaginea in functie de numarul de thread-uri si de thread-ul care ruleaza
+    int start = thread->id * (double)thread->scaled_image->x / thread->noThreads;
+    int end = min((thread->id + 1) * (double)thread->scaled_image->x / thread->noThreads, thread->scaled_image->x);
+    thread->chunk_start = start;
+    thread->chunk_end = end;
+
+    marching_rescale_rows(thread->source, thread->tiled_image, thread->opts->resample, thread->scaled_image, start, end);
+}
+
+/* @brief Calculeaza liniile [start, end) ale grid-ului, fara linia p
+ * @param image imaginea scalata
+ * @param grid grid-ul
+ * @param step_x pasul pe axa x
+ * @param step_y pasul pe axa y
+ * @param sigma valoarea de prag
+ * @param q numarul de coloane
+ * @param start prima linie
+ * @param end linia de dupa ultima (cel mult p)
+*/
+static void gridRows(ppm_image *image, unsigned char **grid, int step_x, int step_y, int sigma, int q, int start, int end) {
+    for (int i = start; i < end; i++) {
+        for (int j = 0; j < q; j++) {
+            ppm_pixel curr_pixel = image->data[i * step_x * image->y + j * step_y];
+
+            unsigned char curr_color = (curr_pixel.red + curr_pixel.green + curr_pixel.blue) / 3;
+
+            if (curr_color > sigma) {
+                grid[i][j] = 0;
+            } else {
+                grid[i][j] = 1;
+            }
+        }
+    }
+
+    // last sample points have no neighbors below / to the right, so we use pixels on the
+    // last row / column of the input image for them
+    for (int i = start; i < end; i++) {
+        ppm_pixel curr_pixel = image->data[i * step_x * image->y + image->x - 1];
+
+        unsigned char curr_color = (curr_pixel.red + curr_pixel.green + curr_pixel.blue) / 3;
+
+        if (curr_color > sigma) {
+            grid[i][q] = 0;
+        } else {
+            grid[i][q] = 1;
+        }
+    }
+}
+
+/* @brief Calculeaza coloanele [start, end) de pe ultima linie a grid-ului (linia p)
+ * @param image imaginea scalata
+ * @param grid grid-ul
+ * @param step_y pasul pe axa y
+ * @param sigma valoarea de prag
+ * @param p numarul de linii
+ * @param start prima coloana
+ * @param end coloana de dupa ultima
+*/
+static void gridLastRow(ppm_image *image, unsigned char **grid, int step_y, int sigma, int p, int start, int end) {
+    for (int j = start; j < end; j++) {
+        ppm_pixel curr_pixel = image->data[(image->x - 1) * image->y + j * step_y];
+
+        unsigned char curr_color = (curr_pixel.red + curr_pixel.green + curr_pixel.blue) / 3;
+
+        if (curr_color > sigma) {
+            grid[p][j] = 0;
+        } else {
+            grid[p][j] = 1;
+        }
+    }
+}
+
+/* @brief Creeaza grid-ul
+ * @param thread informatii utile folosite de thread-ul curent
+ * @param step_x pasul pe axa x
+ * @param step_y pasul pe axa y
+ * @param sigma valoarea de prag
+ * @param p numarul de linii
+ * @param q numarul de coloane
+*/
+static void createGrid(thread_structure *thread, int step_x, int step_y, int sigma, int p, int q) {
+
+    // se imparte imaginea in functie de numarul de thread-uri si de thread-ul care ruleaza
+    int start = thread->id * (double)p / thread->noThreads;
+    int end = min((thread->id + 1) * (double)p / thread->noThreads, p);
+    thread->chunk_start = start;
+    thread->chunk_end = end;
+
+    gridRows(thread->scaled_image, thread->grid, step_x, step_y, sigma, q, start, end);
+
+    // schimb start si stop pentru a paraleliza si forul de mai jos
+    start = thread->id * (double)q / thread->noThreads;
+    end = min((thread->id + 1) * (double)q / thread->noThreads, q);
+
+    gridLastRow(thread->scaled_image, thread->grid, step_y, sigma, p, start, end);
+}
+
+/* @brief Umple celulele [r0, r1) x [c0, c1) cu un contur uniform
+ * @param image imaginea
+ * @param value valoarea octetilor conturului
+ * @param step_x pasul pe axa x
+ * @param step_y pasul pe axa y
+ * @param r0 prima linie de celule
+ * @param r1 linia de dupa ultima
+ * @param c0 prima coloana de celule
+ * @param c1 coloana de dupa ultima
+*/
+static void fillCells(ppm_image *image, int value, int step_x, int step_y, int r0, int r1, int c0, int c1) {
+    for (int r = r0 * step_x; r < r1 * step_x; r++) {
+        memset(&image->data[(size_t)r * image->y + c0 * step_y], value, (size_t)(c1 - c0) * step_y * sizeof(ppm_pixel));
+    }
+}
+
+/* @brief Marcheaza celulele [r0, r1) x [c0, c1). Celulele consecutive de pe o linie care au
+ * conturi uniforme de aceeasi culoare (de obicei cazurile 0 si 15) sunt umplute cu cate un memset
+ * pe fiecare linie de pixeli, in loc sa fie copiate pixel cu pixel.
+ * @param image imaginea
+ * @param contur contururile
+ * @param uniform valorile contururilor uniforme (vezi marching_find_uniform_contours)
+ * @param grid grid-ul; sunt citite liniile r0 ... r1
+ * @param step_x pasul pe axa x
+ * @param step_y pasul pe axa y
+ * @param r0 prima linie de celule
+ * @param r1 linia de dupa ultima
+ * @param c0 prima coloana de celule
+ * @param c1 coloana de dupa ultima
+ * @return numarul de celule umplute cu memset
+*/
+uint64_t marching_march_cells(ppm_image *image, ppm_image **contur, const int *uniform, unsigned char **grid,
+                              int step_x, int step_y, int r0, int r1, int c0, int c1) {
+    uint64_t uniform_cells = 0;
+
+    for (int i = r0; i < r1; i++) {
+        int j = c0;
+
+        while (j < c1) {
+            unsigned char k = 8 * grid[i][j] + 4 * grid[i][j + 1] + 2 * grid[i + 1][j + 1] + 1 * grid[i + 1][j];
+            int value = uniform[k];
+
+            if (value < 0) {
+                update_image(image, contur[k], i * step_x, j * step_y);
+                j++;
+                continue;
+            }
+
+            // cat timp celulele urmatoare au un contur uniform de aceeasi culoare
+            int run = j + 1;
+            while (run < c1) {
+                unsigned char next = 8 * grid[i][run] + 4 * grid[i][run + 1] + 2 * grid[i + 1][run + 1] + 1 * grid[i + 1][run];
+                if (uniform[next] != value) {
+                    break;
+                }
+                run++;
+            }
+
+            fillCells(image, value, step_x, step_y, i, i + 1, j, run);
+            uniform_cells += run - j;
+            j = run;
+        }
+    }
+
+    return uniform_cells;
+}
+
+/* @brief Marcheaza conturul
+ * @param thread informatii utile folosite de thread-ul curent
+ * @param step_x pasul pe axa x
+ * @param step_y pasul pe axa y
+ * @param p numarul de linii
+ * @param q numarul de coloane
+*/
+static void march(thread_structure *thread, int step_x, int step_y, int p, int q) {
+    int start = thread->id * (double)q / thread->noThreads;
+    int end = min((thread->id + 1) * (double)q / thread->noThreads, q);
+    thread->chunk_start = start;
+    thread->chunk_end = end;
+
+    thread->uniform_cells = marching_march_cells(thread->scaled_image, thread->contur, thread->ctx->uniform, thread->grid,
+                                                 step_x, step_y, 0, p, start, end);
+    thread->cells = (uint64_t)p * (end - start);
+}
+
+/* @brief Anunta apelantul ca imaginea de intrare nu mai este citita in job-ul curent.
+ * Apelata de un singur thread, dupa ce toate thread-urile au terminat fazele care o citesc.
+ * @param thread informatii utile folosite de thread-ul curent
+*/
+static void releaseInput(thread_structure *thread) {
+    marching_context *ctx = thread->ctx;
+
+    if (ctx->input_released) {
+        return;
+    }
+    ctx->input_released = 1;
+    if (thread->opts->release_input) {
+        thread->opts->release_input(thread->opts->release_arg);
+    }
+}
+
+/* @brief Marcheaza inceputul unei faze pentru statistici si trace
+ * @param thread informatii utile folosite de thread-ul curent
+*/
+static void phaseBegin(thread_structure *thread) {
+    if (!thread->timed) {
+        return;
+    }
+
+    thread->chunk_start = thread->chunk_end = 0;
+    if (thread->opts->perf_counters) {
+        marching_perf_read(&thread->perf, thread->phase_counters);
+    }
+    thread->phase_start = marching_trace_now();
+}
+
+/* @brief Marcheaza sfarsitul unei faze si salveaza timpul, contoarele si evenimentul din trace
+ * @param thread informatii utile folosite de thread-ul curent
+ * @param phase faza
+*/
+static void phaseEnd(thread_structure *thread, int phase) {
+    static const char *phase_names[PHASE_COUNT] = { "hash", "cache", "pyramid", "repack", "rescale", "grid", "march", "checksum" };
+
+    if (!thread->timed) {
+        return;
+    }
+
+    uint64_t now = marching_trace_now();
+    thread->stats[phase].ran = 1;
+    // in pipeline o faza ruleaza de mai multe ori, pe benzi diferite
+    thread->stats[phase].seconds += (now - thread->phase_start) / 1e9;
+
+    if (thread->opts->perf_counters) {
+        uint64_t values[PERF_EVENT_COUNT];
+
+        marching_perf_read(&thread->perf, values);
+        for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+            thread->stats[phase].counters[i] += values[i] - thread->phase_counters[i];
+        }
+    }
+
+    if (thread->opts->trace_file) {
+        marching_trace_add(&thread->trace, phase_names[phase], TRACE_PHASE, thread->phase_start, now, thread->chunk_start,
+                           thread->chunk_end);
+    }
+}
+
+/* @brief Asteapta celelalte thread-uri la bariera dintre faze; cu trace, asteptarea este inregistrata
+ * @param thread informatii utile folosite de thread-ul curent
+*/
+static void waitBarrier(thread_structure *thread) {
+    if (!thread->opts->trace_file) {
+        pthread_barrier_wait(thread->barrier);
+        return;
+    }
+
+    uint64_t start = marching_trace_now();
+    pthread_barrier_wait(thread->barrier);
+    marching_trace_add(&thread->trace, "barrier", TRACE_WAIT, start, marching_trace_now(), -1, -1);
+}
+
+/* @brief Construieste nivelurile piramidei, fiecare din cel anterior. Pentru fiecare nivel
+ * thread-urile isi impart liniile, iar intre niveluri asteapta la bariera.
+ * @param thread informatii utile folosite de thread-ul curent
+*/
+static void pyramidImage(thread_structure *thread) {
+    for (int l = 0; l < thread->noLevels; l++) {
+        const ppm_image *src = l ? &thread->levels[l - 1] : thread->image;
+        ppm_image *dst = &thread->levels[l];
+        int start = thread->id * (double)dst->y / thread->noThreads;
+        int end = min((thread->id + 1) * (double)dst->y / thread->noThreads, dst->y);
+        thread->chunk_start = start;
+        thread->chunk_end = end;
+
+        if (l) {
+            waitBarrier(thread);
+        }
+        marching_decimate_rows(src, dst, start, end);
+    }
+}
+
+/* @brief Ultima banda din care grid-ul benzii g citeste pixeli. Punctele de pe coloana q sunt
+ * citite de la indexul i * step * y + x - 1, care poate depasi linia i * step.
+ * @param image imaginea scalata
+ * @param bands numarul de benzi
+ * @param g banda
+*/
+static int gridLastBand(ppm_image *image, int bands, int g) {
+    if (g == bands - 1) {
+        return g;
+    }
+
+    size_t last = (size_t)((g + 1) * PIPELINE_BAND - 1) * STEP * image->y + image->x - 1;
+
+    return min(last / image->y / (PIPELINE_BAND * STEP), bands - 1);
+}
+
+/* @brief Executa o sarcina din pipeline pe o banda: scalarea (sau copierea) liniilor de pixeli,
+ * calculul liniilor din grid sau marcarea liniilor de celule
+ * @param thread informatii utile folosite de thread-ul curent
+ * @param phase faza sarcinii
+ * @param band banda
+ * @param p numarul de linii
+ * @param q numarul de coloane
+*/
+static void runTask(thread_structure *thread, int phase, int band, int p, int q) {
+    ppm_image *image = thread->scaled_image;
+    int last = band == thread->ctx->bands - 1;
+    int start = band * PIPELINE_BAND;
+    int end = last ? p : start + PIPELINE_BAND;
+
+    if (phase == PHASE_RESCALE) {
+        // ultima banda contine si liniile de pixeli de dupa ultima celula
+        int row_start = start * STEP;
+        int row_end = last ? image->x : end * STEP;
+        thread->chunk_start = row_start;
+        thread->chunk_end = row_end;
+
+        if (!(thread->image->x <= RESCALE_X && thread->image->y <= RESCALE_Y)) {
+            marching_rescale_rows(thread->source, thread->tiled_image, thread->opts->resample, image, row_start, row_end);
+        } else {
+            memcpy(&image->data[(size_t)row_start * image->y], &thread->image->data[(size_t)row_start * image->y],
+                   (size_t)(row_end - row_start) * image->y * sizeof(ppm_pixel));
+        }
+    } else if (phase == PHASE_GRID) {
+        thread->chunk_start = start;
+        thread->chunk_end = end;
+
+        gridRows(image, thread->grid, STEP, STEP, SIGMA, q, start, end);
+        if (last) {
+            gridLastRow(image, thread->grid, STEP, SIGMA, p, 0, q);
+        }
+    } else {
+        thread->chunk_start = start;
+        thread->chunk_end = end;
+
+        thread->uniform_cells += marching_march_cells(image, thread->contur, thread->ctx->uniform, thread->grid,
+                                                      STEP, STEP, start, end, 0, q);
+        thread->cells += (uint64_t)(end - start) * q;
+    }
+}
+
+/* @brief Alege urmatoarea sarcina din pipeline. Marcarea benzii b asteapta grid-ul benzilor
+ * 0 ... b + 1, pentru ca grid-ul unei benzi anterioare poate citi pixeli din banda b, pe care
+ * marcarea ii suprascrie. Grid-ul benzii g asteapta scalarea benzilor din care citeste.
+ * Sarcinile sunt alese in ordinea marcare, grid, scalare, ca o banda sa ajunga cat mai repede
+ * la capat cat timp liniile ei sunt inca in cache.
+ * @param ctx contextul; apelantul detine pipeline_lock
+ * @param image imaginea scalata
+ * @param band banda aleasa
+ * @return faza sarcinii, -1 daca nu exista o sarcina disponibila, PHASE_COUNT daca job-ul s-a terminat
+*/
+static int nextTask(marching_context *ctx, ppm_image *image, int *band) {
+    if (ctx->next_march < ctx->bands && ctx->grid_prefix > min(ctx->next_march + 1, ctx->bands - 1)) {
+        *band = ctx->next_march++;
+        return PHASE_MARCH;
+    }
+
+    if (ctx->next_grid < ctx->bands) {
+        int g = ctx->next_grid;
+        int last = gridLastBand(image, ctx->bands, g);
+        int ready = 1;
+
+        for (int b = g; b <= last && ready; b++) {
+            ready = ctx->band_state[b] & BAND_RESCALED;
+        }
+        if (ready) {
+            *band = ctx->next_grid++;
+            return PHASE_GRID;
+        }
+    }
+
+    if (ctx->next_rescale < ctx->bands) {
+        *band = ctx->next_rescale++;
+        return PHASE_RESCALE;
+    }
+
+    return ctx->marched == ctx->bands ? PHASE_COUNT : -1;
+}
+
+/* @brief Fazele de scalare, grid si marcare, executate pe benzi, fara bariere (--pipeline)
+ * @param thread informatii utile folosite de thread-ul curent
+ * @param p numarul de linii
+ * @param q numarul de coloane
+*/
+static void runPipeline(thread_structure *thread, int p, int q) {
+    marching_context *ctx = thread->ctx;
+
+    thread->cells = 0;
+    thread->uniform_cells = 0;
+
+    pthread_mutex_lock(&ctx->pipeline_lock);
+    while (1) {
+        int band;
+        int phase = nextTask(ctx, thread->scaled_image, &band);
+
+        if (phase == PHASE_COUNT) {
+            break;
+        }
+        if (phase < 0) {
+            uint64_t start = marching_trace_now();
+            pthread_cond_wait(&ctx->pipeline_cond, &ctx->pipeline_lock);
+            if (thread->opts->trace_file) {
+                marching_trace_add(&thread->trace, "wait", TRACE_WAIT, start, marching_trace_now(), -1, -1);
+            }
+            continue;
+        }
+        pthread_mutex_unlock(&ctx->pipeline_lock);
+
+        phaseBegin(thread);
+        runTask(thread, phase, band, p, q);
+        phaseEnd(thread, phase);
+
+        pthread_mutex_lock(&ctx->pipeline_lock);
+        if (phase == PHASE_RESCALE) {
+            ctx->band_state[band] |= BAND_RESCALED;
+            // dupa ultima banda scalata imaginea de intrare nu mai este citita
+            if (++ctx->rescaled == ctx->bands) {
+                releaseInput(thread);
+            }
+        } else if (phase == PHASE_GRID) {
+            ctx->band_state[band] |= BAND_GRID;
+            while (ctx->grid_prefix < ctx->bands && (ctx->band_state[ctx->grid_prefix] & BAND_GRID)) {
+                ctx->grid_prefix++;
+            }
+        } else {
+            ctx->marched++;
+        }
+        pthread_cond_broadcast(&ctx->pipeline_cond);
+    }
+    pthread_mutex_unlock(&ctx->pipeline_lock);
+}
+
+/* @brief Ruleaza un job pe o regiune de interes (--roi). Se scaleaza doar fereastra aliniata la
+ * celule care contine regiunea, punctele din grid ale celulelor ei sunt calculate direct din
+ * imaginea de intrare (marching_grid_point), iar la sfarsit regiunea este copiata din fereastra.
+ * @param thread informatii utile folosite de thread-ul curent
+*/
+static void runRoi(thread_structure *thread) {
+    marching_context *ctx = thread->ctx;
+    ppm_image *window = &ctx->roi_window;
+    ppm_image *out = thread->scaled_image;
+    const ppm_image *in = thread->image;
+    int *box = ctx->roi_box;
+    int *cells = ctx->roi_cells;
+    int x = ctx->roi_size[0], y = ctx->roi_size[1];
+    int row0 = cells[0] * STEP, col0 = cells[2] * STEP;
+    int rows = cells[1] - cells[0], cols = cells[3] - cells[2];
+
+    phaseBegin(thread);
+    int start = thread->id * (double)window->x / thread->noThreads;
+    int end = min((thread->id + 1) * (double)window->x / thread->noThreads, window->x);
+    thread->chunk_start = start;
+    thread->chunk_end = end;
+
+    for (int i = start; i < end; i++) {
+        ppm_pixel *row = &window->data[(size_t)i * window->y];
+
+        if (!(in->x <= RESCALE_X && in->y <= RESCALE_Y)) {
+            for (int j = 0; j < window->y; j++) {
+                uint8_t sample[3];
+
+                marching_rescale_pixel(in, NULL, thread->opts->resample, x, y, row0 + i, col0 + j, sample);
+                row[j].red = sample[0];
+                row[j].green = sample[1];
+                row[j].blue = sample[2];
+            }
+        } else {
+            memcpy(row, &in->data[(size_t)(row0 + i) * y + col0], window->y * sizeof(ppm_pixel));
+        }
+    }
+    phaseEnd(thread, PHASE_RESCALE);
+
+    phaseBegin(thread);
+    start = thread->id * (double)(rows + 1) / thread->noThreads;
+    end = min((thread->id + 1) * (double)(rows + 1) / thread->noThreads, rows + 1);
+    thread->chunk_start = start;
+    thread->chunk_end = end;
+
+    for (int i = start; i < end; i++) {
+        for (int j = 0; j <= cols; j++) {
+            thread->grid[i][j] = marching_grid_point(in, thread->opts->resample, x, y, cells[0] + i, cells[2] + j);
+        }
+    }
+    phaseEnd(thread, PHASE_GRID);
+    waitBarrier(thread);
+
+    if (thread->id == 0) {
+        releaseInput(thread);
+    }
+
+    phaseBegin(thread);
+    start = thread->id * (double)cols / thread->noThreads;
+    end = min((thread->id + 1) * (double)cols / thread->noThreads, cols);
+    thread->chunk_start = start;
+    thread->chunk_end = end;
+
+    thread->uniform_cells = marching_march_cells(window, thread->contur, ctx->uniform, thread->grid, STEP, STEP, 0, rows, start, end);
+    thread->cells = (uint64_t)rows * (end - start);
+    phaseEnd(thread, PHASE_MARCH);
+    waitBarrier(thread);
+
+    // imaginea de iesire are box[2] coloane si box[3] linii
+    phaseBegin(thread);
+    start = thread->id * (double)box[3] / thread->noThreads;
+    end = min((thread->id + 1) * (double)box[3] / thread->noThreads, box[3]);
+    thread->chunk_start = start;
+    thread->chunk_end = end;
+
+    for (int i = start; i < end; i++) {
+        memcpy(&out->data[(size_t)i * box[2]], &window->data[(size_t)(box[1] - row0 + i) * window->y + box[0] - col0],
+               box[2] * sizeof(ppm_pixel));
+    }
+    phaseEnd(thread, PHASE_MARCH);
+}
+
+/* @brief Calculeaza hash-urile blocurilor imaginii de intrare. Fiecare thread hash-uieste un
+ * interval de blocuri; impartirea in blocuri nu depinde de numarul de thread-uri.
+ * @param thread informatii utile folosite de thread-ul curent
+*/
+static void hashInput(thread_structure *thread) {
+    marching_context *ctx = thread->ctx;
+    size_t size = (size_t)thread->image->x * thread->image->y * sizeof(ppm_pixel);
+    int count = (int)ctx->hash_count;
+    int start = thread->id * (double)count / thread->noThreads;
+    int end = min((thread->id + 1) * (double)count / thread->noThreads, count);
+    thread->chunk_start = start;
+    thread->chunk_end = end;
+
+    for (int b = start; b < end; b++) {
+        ctx->hash_blocks[b] = marching_hash_block(thread->image->data, size, b);
+    }
+}
+
+/* @brief Calculeaza hash-urile blocurilor imaginii de iesire, pentru suma de control (--checksum).
+ * Ca la hashInput, fiecare thread hash-uieste un interval de blocuri.
+ * @param thread informatii utile folosite de thread-ul curent
+*/
+static void checksumOutput(thread_structure *thread) {
+    marching_context *ctx = thread->ctx;
+    ppm_image *out = thread->scaled_image;
+    size_t size = (size_t)out->x * out->y * sizeof(ppm_pixel);
+    int count = (int)ctx->checksum_count;
+    int start = thread->id * (double)count / thread->noThreads;
+    int end = min((thread->id + 1) * (double)count / thread->noThreads, count);
+    thread->chunk_start = start;
+    thread->chunk_end = end;
+
+    for (int b = start; b < end; b++) {
+        ctx->checksum_blocks[b] = marching_hash_block(out->data, size, b);
+    }
+}
+
+/* @brief Calculeaza cheia job-ului si cauta in cache imaginea scalata si grid-ul.
+ * Apelata de un singur thread, dupa hashInput.
+ * @param thread informatii utile folosite de thread-ul curent
+ * @param p numarul de linii de celule
+ * @param q numarul de coloane de celule
+*/
+static void lookupCache(thread_structure *thread, int p, int q) {
+    marching_context *ctx = thread->ctx;
+    const ppm_image *in = thread->image;
+    ppm_image *out = thread->scaled_image;
+    const char *dir = thread->opts->cache_dir;
+
+    // parametrii de care depinde imaginea scalata
+    uint64_t params[] = { CACHE_VERSION, in->x, in->y, out->x, out->y, STEP, thread->noLevels, thread->opts->resample };
+    uint64_t pixels = marching_hash_combine(ctx->hash_blocks, ctx->hash_count, 0);
+    ctx->cache_key = marching_hash_combine(params, sizeof(params) / sizeof(params[0]), pixels);
+
+    ctx->image_hit = marching_cache_lookup_image(dir, ctx->cache_key, out->x, out->y, &ctx->cache_image);
+    ctx->grid_hit = ctx->image_hit && marching_cache_lookup_grid(dir, ctx->cache_key, SIGMA, p, q, &ctx->cache_grid);
+}
+
+/* @brief Copiaza imaginea scalata din intrarea mapata din cache. Fiecare thread copiaza o banda de linii.
+ * @param thread informatii utile folosite de thread-ul curent
+*/
+static void copyCached(thread_structure *thread) {
+    ppm_image *out = thread->scaled_image;
+    const ppm_pixel *cached = (const ppm_pixel *)thread->ctx->cache_image.data;
+    int start = thread->id * (double)out->x / thread->noThreads;
+    int end = min((thread->id + 1) * (double)out->x / thread->noThreads, out->x);
+    size_t row = (size_t)out->y;
+    thread->chunk_start = start;
+    thread->chunk_end = end;
+
+    memcpy(&out->data[row * start], &cached[row * start], row * (end - start) * sizeof(ppm_pixel));
+}
+
+/* @brief Copiaza grid-ul din intrarea mapata din cache, unde liniile sunt consecutive.
+ * Fiecare thread copiaza o banda de linii.
+ * @param thread informatii utile folosite de thread-ul curent
+ * @param p numarul de linii de celule
+ * @param q numarul de coloane de celule
+*/
+static void copyCachedGrid(thread_structure *thread, int p, int q) {
+    int start = thread->id * (double)(p + 1) / thread->noThreads;
+    int end = min((thread->id + 1) * (double)(p + 1) / thread->noThreads, p + 1);
+    size_t row = (size_t)q + 1;
+    thread->chunk_start = start;
+    thread->chunk_end = end;
+
+    for (int i = start; i < end; i++) {
+        memcpy(thread->grid[i], thread->ctx->cache_grid.data + row * i, row);
+    }
+}
+
+/* @brief Salveaza in cache imaginea scalata si grid-ul care nu au fost gasite, apoi sterge
+ * intrarile vechi peste limita. Apelata de un singur thread, inainte ca march sa modifice imaginea.
+ * Erorile sunt ignorate: job-ul are deja rezultatul.
+ * @param thread informatii utile folosite de thread-ul curent
+ * @param p numarul de linii de celule
+ * @param q numarul de coloane de celule
+*/
+static void storeCache(thread_structure *thread, int p, int q) {
+    marching_context *ctx = thread->ctx;
+    const char *dir = thread->opts->cache_dir;
+
+    if (!ctx->image_hit) {
+        marching_cache_store_image(dir, ctx->cache_key, thread->scaled_image);
+    }
+    if (!ctx->grid_hit) {
+        marching_cache_store_grid(dir, ctx->cache_key, SIGMA, p, q, thread->grid);
+    }
+
+    marching_cache_evict(dir, thread->opts->cache_limit);
+}
+
+/* @brief Fazele algoritmului: scalare (sau copiere), grid si marcare
+ * @param thread informatii utile folosite de thread-ul curent
+*/
+static void runMarching(thread_structure *thread) {
+    if (thread->opts->roi) {
+        runRoi(thread);
+        return;
+    }
+
+    int step_x = STEP;
+    int step_y = STEP;
+
+    int p = thread->scaled_image->x / step_x;
+    int q = thread->scaled_image->y / step_y;
+    int sigma = SIGMA;
+
+    // Se da rescale doar daca imaginea este mai mare decat cea dorita
+    int rescale = !(thread->image->x <= RESCALE_X && thread->image->y <= RESCALE_Y);
+    marching_context *ctx = thread->ctx;
+
+    // cheia din cache depinde de toata imaginea de intrare, deci toate blocurile trebuie
+    // hash-uite inainte de cautare
+    if (ctx->cache_used) {
+        phaseBegin(thread);
+        hashInput(thread);
+        phaseEnd(thread, PHASE_HASH);
+        waitBarrier(thread);
+
+        if (thread->id == 0) {
+            phaseBegin(thread);
+            lookupCache(thread, p, q);
+            phaseEnd(thread, PHASE_CACHE);
+        }
+        waitBarrier(thread);
+
+        if (ctx->image_hit && thread->id == 0) {
+            releaseInput(thread);
+        }
+    }
+
+    if (rescale && !ctx->image_hit) {
+        if (thread->noLevels) {
+            phaseBegin(thread);
+            pyramidImage(thread);
+            phaseEnd(thread, PHASE_PYRAMID);
+            waitBarrier(thread);
+        }
+
+        if (thread->tiled_image) {
+            phaseBegin(thread);
+            repackImage(thread);
+            phaseEnd(thread, PHASE_REPACK);
+            waitBarrier(thread);
+        }
+
+        // scalarea citeste din ultimul nivel al piramidei sau din imaginea pe tile-uri
+        if ((thread->noLevels || thread->tiled_image) && thread->id == 0) {
+            releaseInput(thread);
+        }
+    }
+
+    if (thread->opts->pipeline) {
+        runPipeline(thread, p, q);
+        return;
+    }
+
+    if (ctx->image_hit) {
+        phaseBegin(thread);
+        copyCached(thread);
+        phaseEnd(thread, PHASE_RESCALE);
+    } else if (rescale) {
+        phaseBegin(thread);
+        rescaleImage(thread);
+        phaseEnd(thread, PHASE_RESCALE);
+    } else {
+        // conturul se deseneaza peste imaginea de iesire, intrarea ramane neschimbata
+        phaseBegin(thread);
+        copyImage(thread);
+        phaseEnd(thread, PHASE_RESCALE);
+    }
+    waitBarrier(thread);
+
+    if (thread->id == 0) {
+        releaseInput(thread);
+    }
+
+    phaseBegin(thread);
+    if (ctx->grid_hit) {
+        copyCachedGrid(thread, p, q);
+    } else {
+        createGrid(thread, step_x, step_y, sigma, p, q);
+    }
+    phaseEnd(thread, PHASE_GRID);
+
+    waitBarrier(thread);
+
+    // imaginea scalata se salveaza inainte ca march sa deseneze conturul peste ea
+    if (ctx->cache_used && !(ctx->image_hit && ctx->grid_hit)) {
+        if (thread->id == 0) {
+            phaseBegin(thread);
+            storeCache(thread, p, q);
+            phaseEnd(thread, PHASE_CACHE);
+        }
+        waitBarrier(thread);
+    }
+
+    phaseBegin(thread);
+    march(thread, step_x, step_y, p, q);
+    phaseEnd(thread, PHASE_MARCH);
+}
+
+/* @brief Executa un job pe thread-ul curent: fazele algoritmului si, cu --checksum, suma de
+ * control a imaginii de iesire, dupa ce toate thread-urile au terminat de scris in ea
+ * @param thread informatii utile folosite de thread-ul curent
+*/
+static void runPhases(thread_structure *thread) {
+    memset(thread->stats, 0, sizeof(thread->stats));
+    thread->timed = thread->opts->stats || thread->opts->perf_counters || thread->opts->trace_file;
+    thread->trace.count = 0;
+    thread->trace.dropped = 0;
+
+    // contoarele se deschid din thread-ul care le foloseste, la primul job care le cere
+    if (thread->opts->perf_counters && !thread->perf_opened) {
+        marching_perf_open(&thread->perf);
+        thread->perf_opened = 1;
+    }
+
+    runMarching(thread);
+
+    if (thread->opts->checksum) {
+        waitBarrier(thread);
+
+        phaseBegin(thread);
+        checksumOutput(thread);
+        phaseEnd(thread, PHASE_CHECKSUM);
+    }
+}
+
+/* @brief Elibereaza resursele unui thread: contoarele hardware si buffer-ul de trace
+ * @param thread informatii utile folosite de thread-ul curent
+*/
+static void finishThread(thread_structure *thread) {
+    if (thread->perf_opened) {
+        marching_perf_close(&thread->perf);
+        thread->perf_opened = 0;
+    }
+    marching_trace_free(&thread->trace);
+}
+
+/* @brief Functia executata de fiecare thread. Thread-ul citeste contururile o singura data,
+ * apoi executa job-uri pana cand contextul este distrus.
+ * @param arg informatii utile folosite de thread-ul curent
+*/
+static void *thread_function(void *arg) {
+    thread_structure *thread = (thread_structure *)arg;
+    marching_context *ctx = thread->ctx;
+
+    // barierele sunt dimensionate pentru toate thread-urile, deci astept sa fie create toate
+    pthread_mutex_lock(&ctx->startup_lock);
+    while (ctx->startup == STARTUP_PENDING) {
+        pthread_cond_wait(&ctx->startup_cond, &ctx->startup_lock);
+    }
+    int aborted = ctx->startup == STARTUP_ABORT;
+    pthread_mutex_unlock(&ctx->startup_lock);
+
+    if (aborted) {
+        return NULL;
+    }
+
+    contur(thread);
+    pthread_barrier_wait(&ctx->job_barrier);
+
+    while (1) {
+        // astept urmatorul job
+        pthread_barrier_wait(&ctx->job_barrier);
+        if (ctx->shutdown) {
+            break;
+        }
+
+        runPhases(thread);
+
+        // anunt ca job-ul s-a terminat
+        pthread_barrier_wait(&ctx->job_barrier);
+    }
+
+    finishThread(thread);
+
+    return NULL;
+}
+
+/* @brief Elibereaza buffer-ele de lucru pastrate intre job-uri; urmatorul job le realoca
+ * @param ctx contextul
+*/
+static void trimContext(marching_context *ctx) {
+    marching_free_tiled(ctx->tiled_image);
+    ctx->tiled_image = NULL;
+    ctx->tiled_capacity = 0;
+    for (int b = 0; b < 2; b++) {
+        free(ctx->level_block[b]);
+        ctx->level_block[b] = NULL;
+        ctx->level_capacity[b] = 0;
+    }
+    free(ctx->band_state);
+    ctx->band_state = NULL;
+    ctx->band_capacity = 0;
+    free(ctx->roi_window.data);
+    ctx->roi_window.data = NULL;
+    ctx->roi_capacity = 0;
+    free(ctx->grid_block);
+    ctx->grid_block = NULL;
+    ctx->grid_capacity = 0;
+    free(ctx->grid);
+    ctx->grid = NULL;
+    ctx->grid_rows = 0;
+    free(ctx->hash_blocks);
+    ctx->hash_blocks = NULL;
+    ctx->hash_capacity = 0;
+    free(ctx->checksum_blocks);
+    ctx->checksum_blocks = NULL;
+    ctx->checksum_capacity = 0;
+}
+
+/* @brief Elibereaza memoria contextului. Thread-urile trebuie sa fie deja oprite.
+ * @param ctx contextul
+*/
+static void freeContext(marching_context *ctx) {
+    if (ctx->threads) {
+        for (int i = 0; i < ctx->noThreads; ++i) {
+            free(ctx->threads[i]);
+        }
+    }
+    free(ctx->threads);
+    free(ctx->tid);
+
+    if (ctx->contur) {
+        for (int i = 0; i < CONTOUR_CONFIG_COUNT; ++i) {
+            if (ctx->contur[i]) {
+                free(ctx->contur[i]->data);
+                free(ctx->contur[i]);
+            }
+        }
+    }
+    free(ctx->contur);
+
+    trimContext(ctx);
+
+    free((char *)ctx->contours_dir);
+    free(ctx);
+}
+
+/* @brief Distruge barierele, mutex-urile si variabilele de conditie ale contextului
+ * @param ctx contextul
+*/
+static void destroySync(marching_context *ctx) {
+    pthread_barrier_destroy(&ctx->barrier);
+    pthread_barrier_destroy(&ctx->job_barrier);
+    pthread_mutex_destroy(&ctx->lock);
+    pthread_mutex_destroy(&ctx->pipeline_lock);
+    pthread_cond_destroy(&ctx->pipeline_cond);
+    pthread_mutex_destroy(&ctx->startup_lock);
+    pthread_cond_destroy(&ctx->startup_cond);
+}
+
+/* @brief Anunta thread-urile create ca pot porni sau ca trebuie sa iasa
+ * @param ctx contextul
+ * @param state STARTUP_RUN sau STARTUP_ABORT
+*/
+static void releaseThreads(marching_context *ctx, int state) {
+    pthread_mutex_lock(&ctx->startup_lock);
+    ctx->startup = state;
+    pthread_cond_broadcast(&ctx->startup_cond);
+    pthread_mutex_unlock(&ctx->startup_lock);
+}
+
+/* @brief Opreste thread-urile contextului, pornite cu STARTUP_RUN
+ * @param ctx contextul
+*/
+static void stopThreads(marching_context *ctx) {
+    if (ctx->inline_jobs) {
+        // nu exista thread-uri; job-urile au rulat pe thread-ul apelantului
+        finishThread(ctx->threads[0]);
+    } else {
+        ctx->shutdown = 1;
+        pthread_barrier_wait(&ctx->job_barrier);
+
+        for (int i = 0; i < ctx->noThreads; ++i) {
+            pthread_join(ctx->tid[i], NULL);
+        }
+    }
+
+    destroySync(ctx);
+}
+
+/* @brief Cauta contururile uniforme: de dimensiunea unei celule, cu toti pixelii gri si de
+ * aceeasi culoare, deci care pot fi desenate cu memset
+ * @param contur contururile
+ * @param uniform pentru fiecare contur, valoarea octetilor sau -1 daca nu este uniform
+*/
+void marching_find_uniform_contours(ppm_image **contur, int uniform[]) {
+    for (int k = 0; k < CONTOUR_CONFIG_COUNT; k++) {
+        ppm_image *contour = contur[k];
+        unsigned char *bytes = (unsigned char *)contour->data;
+        size_t size = (size_t)contour->x * contour->y * sizeof(ppm_pixel);
+
+        uniform[k] = -1;
+        if (contour->x != STEP || contour->y != STEP) {
+            continue;
+        }
+
+        size_t b = 1;
+        while (b < size && bytes[b] == bytes[0]) {
+            b++;
+        }
+        if (b == size) {
+            uniform[k] = bytes[0];
+        }
+    }
+}
+
+/* @brief Creeaza un context: porneste P thread-uri, care citesc contururile si apoi asteapta job-uri.
+ * Cu P = 0 nu se porneste niciun thread: contururile sunt citite, iar job-urile sunt executate,
+ * pe thread-ul apelantului (pentru imaginile mici, unde pornirea thread-urilor si barierele
+ * costa mai mult decat castiga).
+ * @param ctx contextul creat
+ * @param P numarul de thread-uri (0: fara thread-uri)
+ * @param contours_dir directorul cu contururile 0.ppm ... 15.ppm (NULL inseamna ./contours)
+ * @return MARCHING_OK sau un cod de eroare
+*/
+int marching_create(marching_context **ctx, int P, const char *contours_dir) {
+    if (!ctx || P < 0) {
+        return MARCHING_ERR_ARGS;
+    }
+
+    marching_context *new_ctx = calloc(1, sizeof(marching_context));
+    if (!new_ctx) {
+        return MARCHING_ERR_NOMEM;
+    }
+
+    // fara thread-uri, apelantul are rolul singurului worker
+    new_ctx->inline_jobs = !P;
+    if (!P) {
+        P = 1;
+    }
+
+    new_ctx->noThreads = P;
+    new_ctx->contours_dir = strdup(contours_dir ? contours_dir : "./contours");
+    new_ctx->tid = malloc(P * sizeof(pthread_t));
+    new_ctx->threads = calloc(P, sizeof(thread_structure *));
+    new_ctx->contur = (ppm_image **)calloc(CONTOUR_CONFIG_COUNT, sizeof(ppm_image *));
+    if (!new_ctx->contours_dir || !new_ctx->tid || !new_ctx->threads || !new_ctx->contur) {
+        freeContext(new_ctx);
+        return MARCHING_ERR_NOMEM;
+    }
+
+    for (int i = 0; i < P; ++i) {
+        new_ctx->threads[i] = calloc(1, sizeof(thread_structure));
+        if (!new_ctx->threads[i]) {
+            freeContext(new_ctx);
+            return MARCHING_ERR_NOMEM;
+        }
+        new_ctx->threads[i]->id = i;
+        new_ctx->threads[i]->noThreads = P;
+        new_ctx->threads[i]->contur = new_ctx->contur;
+        new_ctx->threads[i]->barrier = &new_ctx->barrier;
+        new_ctx->threads[i]->ctx = new_ctx;
+    }
+
+    pthread_mutex_init(&new_ctx->lock, NULL);
+    pthread_mutex_init(&new_ctx->pipeline_lock, NULL);
+    pthread_cond_init(&new_ctx->pipeline_cond, NULL);
+    pthread_barrier_init(&new_ctx->barrier, NULL, P);
+    pthread_barrier_init(&new_ctx->job_barrier, NULL, P + 1);
+    pthread_mutex_init(&new_ctx->startup_lock, NULL);
+    pthread_cond_init(&new_ctx->startup_cond, NULL);
+
+    if (new_ctx->inline_jobs) {
+        contur(new_ctx->threads[0]);
+    } else {
+        for (int i = 0; i < P; ++i) {
+            if (pthread_create(&(new_ctx->tid[i]), NULL, thread_function, new_ctx->threads[i])) {
+                // thread-urile deja create nu au atins inca barierele; ies, iar contextul este eliberat
+                releaseThreads(new_ctx, STARTUP_ABORT);
+                for (int j = 0; j < i; ++j) {
+                    pthread_join(new_ctx->tid[j], NULL);
+                }
+                destroySync(new_ctx);
+                freeContext(new_ctx);
+                return MARCHING_ERR_THREAD;
+            }
+        }
+        releaseThreads(new_ctx, STARTUP_RUN);
+
+        // astept citirea contururilor
+        pthread_barrier_wait(&new_ctx->job_barrier);
+    }
+
+    for (int i = 0; i < P; ++i) {
+        if (new_ctx->threads[i]->error) {
+            int err = new_ctx->threads[i]->error;
+            stopThreads(new_ctx);
+            freeContext(new_ctx);
+            return err;
+        }
+    }
+
+    marching_find_uniform_contours(new_ctx->contur, new_ctx->uniform);
+
+    *ctx = new_ctx;
+    return MARCHING_OK;
+}
+
+/* @brief Pregateste imaginea pe tile-uri pentru o sursa de dimensiune x * y, refolosind buffer-ul
+ * de la job-urile anterioare daca este suficient de mare
+ * @param ctx contextul
+ * @param x latimea sursei
+ * @param y inaltimea sursei
+ * @return imaginea pe tile-uri sau NULL daca nu exista memorie
+*/
+static tiled_image *reserveTiled(marching_context *ctx, int x, int y) {
+    size_t tiles = (size_t)((x + TILE_SIZE - 1) >> TILE_SHIFT) * ((y + TILE_SIZE - 1) >> TILE_SHIFT);
+
+    if (!ctx->tiled_image || ctx->tiled_capacity < tiles) {
+        marching_free_tiled(ctx->tiled_image);
+        ctx->tiled_capacity = 0;
+        ctx->tiled_image = marching_alloc_tiled(x, y);
+        if (!ctx->tiled_image) {
+            return NULL;
+        }
+        ctx->tiled_capacity = tiles;
+    } else {
+        ctx->tiled_image->x = x;
+        ctx->tiled_image->y = y;
+        ctx->tiled_image->tiles_x = (x + TILE_SIZE - 1) >> TILE_SHIFT;
+        ctx->tiled_image->tiles_y = (y + TILE_SIZE - 1) >> TILE_SHIFT;
+    }
+
+    return ctx->tiled_image;
+}
+
+/* @brief Pregateste nivelurile piramidei pentru o sursa de dimensiune x * y. Nivelurile pare
+ * folosesc primul buffer, iar cele impare pe al doilea, deci fiecare nivel este calculat din
+ * celalalt buffer; buffer-ele sunt refolosite de la job-urile anterioare daca sunt suficient de mari.
+ * @param ctx contextul
+ * @param x latimea sursei
+ * @param y inaltimea sursei
+ * @param count numarul de niveluri
+ * @return 0 la succes, -1 daca nu exista memorie
+*/
+static int reserveLevels(marching_context *ctx, int x, int y, int count) {
+    for (int l = 0; l < count; l++) {
+        x = (x + 1) / 2;
+        y = (y + 1) / 2;
+
+        // primul nivel din fiecare buffer este si cel mai mare
+        size_t pixels = (size_t)x * y;
+        int b = l & 1;
+        if (l < 2 && ctx->level_capacity[b] < pixels) {
+            free(ctx->level_block[b]);
+            ctx->level_capacity[b] = 0;
+            ctx->level_block[b] = (ppm_pixel *)malloc(pixels * sizeof(ppm_pixel));
+            if (!ctx->level_block[b]) {
+                return -1;
+            }
+            ctx->level_capacity[b] = pixels;
+        }
+
+        ctx->levels[l].x = x;
+        ctx->levels[l].y = y;
+        ctx->levels[l].data = ctx->level_block[b];
+    }
+
+    return 0;
+}
+
+/* @brief Pregateste un grid de (p + 1) x (q + 1) puncte. Liniile sunt intr-un singur bloc,
+ * refolosit de la job-urile anterioare daca este suficient de mare.
+ * @param ctx contextul
+ * @param p numarul de linii
+ * @param q numarul de coloane
+ * @return grid-ul sau NULL daca nu exista memorie
+*/
+static unsigned char **reserveGrid(marching_context *ctx, int p, int q) {
+    size_t cells = (size_t)(p + 1) * (q + 1);
+
+    if (ctx->grid_rows < p + 1) {
+        free(ctx->grid);
+        ctx->grid_rows = 0;
+        ctx->grid = (unsigned char **)malloc((p + 1) * sizeof(unsigned char *));
+        if (!ctx->grid) {
+            return NULL;
+        }
+        ctx->grid_rows = p + 1;
+    }
+
+    if (ctx->grid_capacity < cells) {
+        free(ctx->grid_block);
+        ctx->grid_capacity = 0;
+        ctx->grid_block = (unsigned char *)malloc(cells * sizeof(unsigned char));
+        if (!ctx->grid_block) {
+            return NULL;
+        }
+        ctx->grid_capacity = cells;
+    }
+
+    for (int i = 0; i <= p; i++) {
+        ctx->grid[i] = ctx->grid_block + (size_t)i * (q + 1);
+    }
+
+    return ctx->grid;
+}
+
+/* @brief Pregateste planificatorul pipeline-ului pentru un job cu p linii de celule
+ * @param ctx contextul
+ * @param p numarul de linii de celule
+ * @return 0 la succes, -1 daca nu exista memorie
+*/
+static int resetPipeline(marching_context *ctx, int p) {
+    // si o imagine mai mica decat o celula are o banda, care contine toate liniile de pixeli
+    int bands = p > 0 ? (p + PIPELINE_BAND - 1) / PIPELINE_BAND : 1;
+
+    if (ctx->band_capacity < (size_t)bands) {
+        free(ctx->band_state);
+        ctx->band_capacity = 0;
+        ctx->band_state = (unsigned char *)malloc(bands);
+        if (!ctx->band_state) {
+            return -1;
+        }
+        ctx->band_capacity = bands;
+    }
+
+    memset(ctx->band_state, 0, bands);
+    ctx->bands = bands;
+    ctx->next_rescale = ctx->next_grid = ctx->next_march = 0;
+    ctx->grid_prefix = 0;
+    ctx->rescaled = ctx->marched = 0;
+
+    return 0;
+}
+
+/* @brief Pregateste un vector de hash-uri de blocuri (ale imaginii de intrare sau de iesire),
+ * refolosit de la job-urile anterioare daca este suficient de mare
+ * @param blocks vectorul
+ * @param capacity capacitatea vectorului
+ * @param count numarul de blocuri
+ * @return 0 la succes, -1 daca nu exista memorie
+*/
+static int reserveHashBlocks(uint64_t **blocks, size_t *capacity, size_t count) {
+    if (*capacity < count) {
+        free(*blocks);
+        *capacity = 0;
+        *blocks = (uint64_t *)malloc(count * sizeof(uint64_t));
+        if (!*blocks) {
+            return -1;
+        }
+        *capacity = count;
+    }
+
+    return 0;
+}
+
+/* @brief Scrie evenimentele ultimului job in formatul Chrome Trace Event
+ * @param ctx contextul
+ * @param filename fisierul
+ * @return MARCHING_OK sau MARCHING_ERR_IO / MARCHING_ERR_NOMEM
+*/
+static int writeTrace(marching_context *ctx, const char *filename) {
+    trace_buffer **buffers = malloc(ctx->noThreads * sizeof(trace_buffer *));
+    if (!buffers) {
+        return MARCHING_ERR_NOMEM;
+    }
+
+    for (int i = 0; i < ctx->noThreads; i++) {
+        buffers[i] = &ctx->threads[i]->trace;
+    }
+
+    int err = MARCHING_OK;
+    FILE *fp = fopen(filename, "w");
+    if (!fp || marching_trace_write(fp, buffers, ctx->noThreads, ctx->trace_origin)) {
+        err = MARCHING_ERR_IO;
+    }
+    if (fp && fclose(fp)) {
+        err = MARCHING_ERR_IO;
+    }
+
+    free(buffers);
+    return err;
+}
+
+/* @brief Calculeaza dimensiunea imaginii de iesire pentru o imagine de intrare
+ * @param in imaginea de intrare
+ * @param x latimea imaginii de iesire
+ * @param y inaltimea imaginii de iesire
+ * @return MARCHING_OK sau MARCHING_ERR_ARGS
+*/
+int marching_output_size(const ppm_image *in, int *x, int *y) {
+    if (!in || in->x <= 0 || in->y <= 0) {
+        return MARCHING_ERR_ARGS;
+    }
+
+    // we only rescale downwards
+    if (in->x <= RESCALE_X && in->y <= RESCALE_Y) {
+        *x = in->x;
+        *y = in->y;
+    } else {
+        *x = RESCALE_X;
+        *y = RESCALE_Y;
+    }
+
+    return MARCHING_OK;
+}
+
+/* @brief Numara celulele al caror caz (configuratia celor 4 colturi) difera intre grid-ul calculat
+ * cu un nucleu de esantionare si cel calculat cu interpolarea bicubica. Sunt calculate doar
+ * punctele din grid (marching_grid_point), cate doua linii odata, pe thread-ul apelantului.
+ * @param in imaginea de intrare
+ * @param resample nucleul comparat (MARCHING_RESAMPLE_*)
+ * @param pyramid 1 daca job-ul scaleaza din ultimul nivel al piramidei (marching_options.pyramid)
+ * @param changed numarul de celule care si-au schimbat cazul
+ * @param cells numarul total de celule
+ * @return MARCHING_OK, MARCHING_ERR_ARGS sau MARCHING_ERR_NOMEM
+*/
+int marching_resample_diff(const ppm_image *in, int resample, int pyramid, uint64_t *changed, uint64_t *cells) {
+    int x, y;
+
+    if (!in || !in->data || !changed || !cells || marching_output_size(in, &x, &y) ||
+        resample < 0 || resample >= MARCHING_RESAMPLE_COUNT) {
+        return MARCHING_ERR_ARGS;
+    }
+
+    int p = x / STEP;
+    int q = y / STEP;
+    *changed = 0;
+    *cells = (uint64_t)p * q;
+
+    // imaginile mici nu sunt scalate, deci nucleul nu conteaza
+    if ((in->x <= RESCALE_X && in->y <= RESCALE_Y) || resample == MARCHING_RESAMPLE_BICUBIC) {
+        return MARCHING_OK;
+    }
+
+    // cu piramida, ambele nuclee esantioneaza ultimul nivel, ca in prepareJob; nivelurile
+    // alterneaza intre doua buffer-e, ca in reserveLevels
+    const ppm_image *source = in;
+    ppm_image levels[2];
+    ppm_pixel *blocks[2] = { NULL, NULL };
+    int count = pyramid ? marching_pyramid_levels(in->x, in->y, RESCALE_X, RESCALE_Y) : 0;
+    for (int l = 0; l < count; l++) {
+        ppm_image *dst = &levels[l & 1];
+        dst->x = (source->x + 1) / 2;
+        dst->y = (source->y + 1) / 2;
+
+        // primul nivel din fiecare buffer este si cel mai mare
+        if (l < 2) {
+            blocks[l] = (ppm_pixel *)malloc((size_t)dst->x * dst->y * sizeof(ppm_pixel));
+            if (!blocks[l]) {
+                free(blocks[0]);
+                return MARCHING_ERR_NOMEM;
+            }
+        }
+        dst->data = blocks[l & 1];
+
+        marching_decimate_rows(source, dst, 0, dst->y);
+        source = dst;
+    }
+
+    // pentru fiecare punct: bitul 0 cu nucleul ales, bitul 1 cu interpolarea bicubica
+    unsigned char *rows = (unsigned char *)malloc(2 * (size_t)(q + 1));
+    if (!rows) {
+        free(blocks[0]);
+        free(blocks[1]);
+        return MARCHING_ERR_NOMEM;
+    }
+
+    unsigned char *prev = rows, *curr = rows + q + 1;
+    for (int i = 0; i <= p; i++) {
+        for (int j = 0; j <= q; j++) {
+            curr[j] = marching_grid_point(source, resample, x, y, i, j) | marching_grid_point(source, MARCHING_RESAMPLE_BICUBIC, x, y, i, j) << 1;
+        }
+
+        // cazul unei celule difera daca cel putin un colt difera
+        for (int j = 0; i > 0 && j < q; j++) {
+            unsigned char corners[4] = { prev[j], prev[j + 1], curr[j], curr[j + 1] };
+            int differs = 0;
+
+            for (int k = 0; k < 4; k++) {
+                differs |= (corners[k] & 1) != (corners[k] >> 1);
+            }
+            *changed += differs;
+        }
+
+        unsigned char *tmp = prev;
+        prev = curr;
+        curr = tmp;
+    }
+
+    free(rows);
+    free(blocks[0]);
+    free(blocks[1]);
+    return MARCHING_OK;
+}
+
+/* @brief Pregateste buffer-ele si thread-urile pentru un job pe toata imaginea
+ * @param ctx contextul
+ * @param in imaginea de intrare
+ * @param out imaginea de iesire
+ * @param opts optiunile job-ului
+ * @return MARCHING_OK sau MARCHING_ERR_NOMEM
+*/
+static int prepareJob(marching_context *ctx, const ppm_image *in, ppm_image *out, const marching_options *opts) {
+    int rescale = !(in->x <= RESCALE_X && in->y <= RESCALE_Y);
+
+    // cu piramida, scalarea porneste de la ultimul nivel
+    const ppm_image *source = in;
+    int levels = 0;
+    uint64_t level_pixels = 0;
+    if (opts->pyramid && rescale) {
+        levels = marching_pyramid_levels(in->x, in->y, RESCALE_X, RESCALE_Y);
+        if (reserveLevels(ctx, in->x, in->y, levels)) {
+            return MARCHING_ERR_NOMEM;
+        }
+        for (int l = 0; l < levels; l++) {
+            level_pixels += (uint64_t)ctx->levels[l].x * ctx->levels[l].y;
+        }
+        if (levels) {
+            source = &ctx->levels[levels - 1];
+        }
+    }
+
+    // imaginea sursa se rearanjeaza pe tile-uri doar daca va fi scalata bicubic; celelalte
+    // nuclee citesc vecinatati mici sau linii consecutive, pentru care tile-urile nu ajuta
+    tiled_image *tiled = NULL;
+    if (opts->tiled && rescale && opts->resample == MARCHING_RESAMPLE_BICUBIC) {
+        tiled = reserveTiled(ctx, source->x, source->y);
+        if (!tiled) {
+            return MARCHING_ERR_NOMEM;
+        }
+    }
+
+    // grid-ul acopera imaginea scalata, nu pe cea de intrare
+    int p = out->x / STEP;
+    int q = out->y / STEP;
+    unsigned char **grid = reserveGrid(ctx, p, q);
+    if (!grid) {
+        return MARCHING_ERR_NOMEM;
+    }
+
+    // coltul grid[p][q] nu este calculat de createGrid (nici in varianta secventiala), dar este
+    // citit de march. Cu un grid proaspat alocat era 0; cu buffer-ul refolosit trebuie pus explicit.
+    grid[p][q] = 0;
+
+    if (opts->pipeline && resetPipeline(ctx, p)) {
+        return MARCHING_ERR_NOMEM;
+    }
+
+    // doar imaginile scalate se pun in cache; copierea unei imagini mici nu costa mai mult decat citirea ei
+    size_t input_size = (size_t)in->x * in->y * sizeof(ppm_pixel);
+    ctx->cache_used = opts->cache_dir && rescale && !opts->pipeline;
+    ctx->hash_count = marching_hash_block_count(input_size);
+    if (ctx->cache_used && reserveHashBlocks(&ctx->hash_blocks, &ctx->hash_capacity, ctx->hash_count)) {
+        return MARCHING_ERR_NOMEM;
+    }
+
+    ctx->next_row = 0;
+
+    memset(ctx->phase_units, 0, sizeof(ctx->phase_units));
+    ctx->phase_units[PHASE_HASH] = ctx->cache_used ? (uint64_t)in->x * in->y : 0;
+    ctx->phase_units[PHASE_CACHE] = ctx->cache_used ? (uint64_t)out->x * out->y : 0;
+    ctx->phase_units[PHASE_PYRAMID] = level_pixels;
+    ctx->phase_units[PHASE_REPACK] = tiled ? (uint64_t)source->x * source->y : 0;
+    ctx->phase_units[PHASE_RESCALE] = (uint64_t)out->x * out->y;
+    ctx->phase_units[PHASE_GRID] = (uint64_t)(p + 1) * (q + 1);
+    ctx->phase_units[PHASE_MARCH] = (uint64_t)out->x * out->y;
+
+    for (int i = 0; i < ctx->noThreads; ++i) {
+        ctx->threads[i]->image = in;
+        ctx->threads[i]->source = source;
+        ctx->threads[i]->levels = ctx->levels;
+        ctx->threads[i]->noLevels = levels;
+        ctx->threads[i]->scaled_image = out;
+        ctx->threads[i]->tiled_image = tiled;
+        ctx->threads[i]->grid = grid;
+        ctx->threads[i]->opts = opts;
+    }
+
+    return MARCHING_OK;
+}
+
+/* @brief Calculeaza regiunea de interes in coordonatele imaginii scalate, limitata la imagine
+ * @param in imaginea de intrare
+ * @param opts optiunile job-ului, cu regiunea ceruta
+ * @param box coloana, linia, latimea si inaltimea regiunii
+ * @return MARCHING_OK sau MARCHING_ERR_ARGS daca regiunea este vida
+*/
+static int roiBox(const ppm_image *in, const marching_options *opts, int box[4]) {
+    int x, y;
+
+    if (marching_output_size(in, &x, &y) || opts->roi_w <= 0 || opts->roi_h <= 0) {
+        return MARCHING_ERR_ARGS;
+    }
+
+    // liniile si coloanele din imaginea scalata
+    long long r0 = opts->roi_y, r1 = (long long)opts->roi_y + opts->roi_h;
+    long long c0 = opts->roi_x, c1 = (long long)opts->roi_x + opts->roi_w;
+
+    if (opts->roi_input && !(in->x <= RESCALE_X && in->y <= RESCALE_Y)) {
+        // linia i a imaginii scalate esantioneaza coloana i * in->x / (x - 1) din intrare, iar
+        // coloana j linia j * in->y / (y - 1): imaginea scalata este transpusa fata de intrare
+        // (la fel ca in varianta secventiala), deci si regiunea
+        r0 = (long long)opts->roi_x * (x - 1) / in->x;
+        r1 = ((long long)opts->roi_x + opts->roi_w) * (x - 1) / in->x + 1;
+        c0 = (long long)opts->roi_y * (y - 1) / in->y;
+        c1 = ((long long)opts->roi_y + opts->roi_h) * (y - 1) / in->y + 1;
+    }
+
+    r0 = r0 < 0 ? 0 : r0;
+    c0 = c0 < 0 ? 0 : c0;
+    r1 = r1 > x ? x : r1;
+    c1 = c1 > y ? y : c1;
+    if (r0 >= r1 || c0 >= c1) {
+        return MARCHING_ERR_ARGS;
+    }
+
+    box[0] = c0;
+    box[1] = r0;
+    box[2] = c1 - c0;
+    box[3] = r1 - r0;
+
+    return MARCHING_OK;
+}
+
+/* @brief Pregateste un job pe o regiune de interes: fereastra din imaginea scalata care contine
+ * celulele ce acopera regiunea si grid-ul acestor celule
+ * @param ctx contextul
+ * @param in imaginea de intrare
+ * @param out imaginea de iesire, de dimensiunea regiunii
+ * @param opts optiunile job-ului
+ * @return MARCHING_OK sau un cod de eroare
+*/
+static int prepareRoi(marching_context *ctx, const ppm_image *in, ppm_image *out, const marching_options *opts) {
+    int *box = ctx->roi_box;
+    int *cells = ctx->roi_cells;
+    int x, y;
+
+    if (marching_output_size(in, &x, &y) || roiBox(in, opts, box)) {
+        return MARCHING_ERR_ARGS;
+    }
+
+    // celulele care acopera regiunea; liniile / coloanele de dupa ultima celula nu sunt marcate
+    cells[0] = box[1] / STEP;
+    cells[1] = min((box[1] + box[3] + STEP - 1) / STEP, x / STEP);
+    cells[2] = box[0] / STEP;
+    cells[3] = min((box[0] + box[2] + STEP - 1) / STEP, y / STEP);
+
+    ppm_image *window = &ctx->roi_window;
+    window->x = (cells[1] * STEP > box[1] + box[3] ? cells[1] * STEP : box[1] + box[3]) - cells[0] * STEP;
+    window->y = (cells[3] * STEP > box[0] + box[2] ? cells[3] * STEP : box[0] + box[2]) - cells[2] * STEP;
+    ctx->roi_size[0] = x;
+    ctx->roi_size[1] = y;
+
+    size_t pixels = (size_t)window->x * window->y;
+    if (ctx->roi_capacity < pixels) {
+        free(window->data);
+        ctx->roi_capacity = 0;
+        window->data = (ppm_pixel *)malloc(pixels * sizeof(ppm_pixel));
+        if (!window->data) {
+            return MARCHING_ERR_NOMEM;
+        }
+        ctx->roi_capacity = pixels;
+    }
+
+    unsigned char **grid = reserveGrid(ctx, cells[1] - cells[0], cells[3] - cells[2]);
+    if (!grid) {
+        return MARCHING_ERR_NOMEM;
+    }
+
+    memset(ctx->phase_units, 0, sizeof(ctx->phase_units));
+    ctx->phase_units[PHASE_RESCALE] = pixels;
+    ctx->phase_units[PHASE_GRID] = (uint64_t)(cells[1] - cells[0] + 1) * (cells[3] - cells[2] + 1);
+    ctx->phase_units[PHASE_MARCH] = pixels;
+
+    for (int i = 0; i < ctx->noThreads; ++i) {
+        ctx->threads[i]->image = in;
+        ctx->threads[i]->source = in;
+        ctx->threads[i]->noLevels = 0;
+        ctx->threads[i]->scaled_image = out;
+        ctx->threads[i]->tiled_image = NULL;
+        ctx->threads[i]->grid = grid;
+        ctx->threads[i]->opts = opts;
+    }
+
+    return MARCHING_OK;
+}
+
+/* @brief Calculeaza dimensiunea imaginii de iesire a unui job: toata imaginea scalata sau,
+ * cu o regiune de interes, doar regiunea
+ * @param in imaginea de intrare
+ * @param opts optiunile job-ului (NULL inseamna optiunile implicite)
+ * @param x latimea imaginii de iesire
+ * @param y inaltimea imaginii de iesire
+ * @return MARCHING_OK sau MARCHING_ERR_ARGS
+*/
+int marching_result_size(const ppm_image *in, const marching_options *opts, int *x, int *y) {
+    int box[4];
+
+    if (!opts || !opts->roi) {
+        return marching_output_size(in, x, y);
+    }
+    if (!in || in->x <= 0 || in->y <= 0 || roiBox(in, opts, box)) {
+        return MARCHING_ERR_ARGS;
+    }
+
+    *x = box[2];
+    *y = box[3];
+
+    return MARCHING_OK;
+}
+
+/* @brief Memoria rezidenta curenta a procesului, din /proc/self/statm
+ * @return memoria rezidenta in KB, 0 daca nu poate fi citita
+*/
+static long residentMemory(void) {
+    long size, resident = 0;
+    FILE *fp = fopen("/proc/self/statm", "r");
+
+    if (!fp) {
+        return 0;
+    }
+    if (fscanf(fp, "%ld %ld", &size, &resident) != 2) {
+        resident = 0;
+    }
+    fclose(fp);
+
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/* @brief Ruleaza algoritmul pe thread-urile din context si asteapta terminarea lui
+ * @param ctx contextul
+ * @param in imaginea de intrare; nu este modificata
+ * @param out imaginea de iesire, alocata de apelant cu dimensiunea data de marching_result_size
+ * @param opts optiunile job-ului (NULL inseamna optiunile implicite)
+ * @return MARCHING_OK sau un cod de eroare
+*/
+int marching_squares(marching_context *ctx, const ppm_image *in, ppm_image *out, const marching_options *opts) {
+    static const marching_options default_options;
+    int x, y;
+
+    if (!opts) {
+        opts = &default_options;
+    }
+    if (!ctx || !out || !out->data || !in || !in->data || marching_result_size(in, opts, &x, &y)) {
+        return MARCHING_ERR_ARGS;
+    }
+    if (out->x != x || out->y != y || opts->resample < 0 || opts->resample >= MARCHING_RESAMPLE_COUNT) {
+        return MARCHING_ERR_ARGS;
+    }
+    if (opts->roi && (opts->tiled || opts->pyramid || opts->pipeline)) {
+        return MARCHING_ERR_ARGS;
+    }
+
+    pthread_mutex_lock(&ctx->lock);
+
+    ctx->cache_used = ctx->image_hit = ctx->grid_hit = 0;
+    ctx->input_released = 0;
+    ctx->checksum_valid = 0;
+    int err = opts->roi ? prepareRoi(ctx, in, out, opts) : prepareJob(ctx, in, out, opts);
+    if (!err && opts->checksum) {
+        ctx->checksum_count = marching_hash_block_count((size_t)out->x * out->y * sizeof(ppm_pixel));
+        ctx->phase_units[PHASE_CHECKSUM] = (uint64_t)out->x * out->y;
+        if (reserveHashBlocks(&ctx->checksum_blocks, &ctx->checksum_capacity, ctx->checksum_count)) {
+            err = MARCHING_ERR_NOMEM;
+        }
+    }
+    if (err) {
+        pthread_mutex_unlock(&ctx->lock);
+        return err;
+    }
+
+    ctx->stats_valid = opts->stats || opts->perf_counters;
+    ctx->stats_perf = opts->perf_counters;
+
+    // pornesc job-ul si astept sa se termine
+    ctx->trace_origin = marching_trace_now();
+    if (ctx->inline_jobs) {
+        runPhases(ctx->threads[0]);
+    } else {
+        pthread_barrier_wait(&ctx->job_barrier);
+        pthread_barrier_wait(&ctx->job_barrier);
+    }
+
+    marching_cache_release(&ctx->cache_image);
+    marching_cache_release(&ctx->cache_grid);
+
+    // hash-urile blocurilor se combina in ordine, deci suma nu depinde de numarul de thread-uri
+    if (opts->checksum) {
+        ctx->checksum = marching_hash_combine(ctx->checksum_blocks, ctx->checksum_count, HASH_IMAGE_SEED(out->x, out->y));
+        ctx->checksum_valid = 1;
+    }
+
+    if (opts->low_memory) {
+        trimContext(ctx);
+    }
+
+    struct rusage usage;
+    ctx->peak_rss = getrusage(RUSAGE_SELF, &usage) ? 0 : usage.ru_maxrss;
+    ctx->end_rss = residentMemory();
+
+    if (opts->trace_file) {
+        err = writeTrace(ctx, opts->trace_file);
+    }
+
+    pthread_mutex_unlock(&ctx->lock);
+
+    return err;
+}
+
+/* @brief Intoarce suma de control a imaginii de iesire din ultimul job (marching_options.checksum)
+ * @param ctx contextul
+ * @param checksum suma de control
+ * @return MARCHING_OK sau MARCHING_ERR_ARGS daca ultimul job nu a calculat-o
+*/
+int marching_checksum(marching_context *ctx, uint64_t *checksum) {
+    if (!ctx || !checksum || !ctx->checksum_valid) {
+        return MARCHING_ERR_ARGS;
+    }
+
+    *checksum = ctx->checksum;
+    return MARCHING_OK;
+}
+
+/* @brief Calculeaza pe thread-ul apelantului suma de control a unei imagini, aceeasi ca
+ * marching_checksum pentru o imagine de iesire cu aceiasi pixeli
+ * @param img imaginea
+ * @param checksum suma de control
+ * @return MARCHING_OK, MARCHING_ERR_ARGS sau MARCHING_ERR_NOMEM
+*/
+int marching_image_checksum(const ppm_image *img, uint64_t *checksum) {
+    if (!img || !img->data || !checksum || img->x <= 0 || img->y <= 0) {
+        return MARCHING_ERR_ARGS;
+    }
+
+    size_t size = (size_t)img->x * img->y * sizeof(ppm_pixel);
+    if (marching_hash_buffer(img->data, size, HASH_IMAGE_SEED(img->x, img->y), checksum)) {
+        return MARCHING_ERR_NOMEM;
+    }
+
+    return MARCHING_OK;
+}
+
+/* @brief Verifica daca o faza a rulat pe cel putin un thread; in pipeline sarcinile sunt luate
+ * dintr-o coada comuna, deci un thread (chiar si primul) poate sa nu ruleze deloc o faza
+ * @param ctx contextul
+ * @param phase faza
+ * @return 1 daca faza a rulat, altfel 0
+*/
+static int phaseRan(marching_context *ctx, int phase) {
+    for (int i = 0; i < ctx->noThreads; i++) {
+        if (ctx->threads[i]->stats[phase].ran) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* @brief Afiseaza timpii fiecarei faze din ultimul job si, daca au fost cerute, contoarele hardware:
+ * pe fiecare thread ciclurile, instructiunile si IPC, iar pe faza IPC si miss-urile per pixel
+ * (per punct din grid pentru faza de grid, per pixel sursa pentru rearanjarea pe tile-uri,
+ * per pixel calculat pentru piramida)
+ * @param ctx contextul
+ * @param fp stream-ul in care se scrie
+*/
+void marching_print_stats(marching_context *ctx, FILE *fp) {
+    static const char *phase_names[PHASE_COUNT] = { "hash", "cache", "pyramid", "repack", "rescale", "grid", "march", "checksum" };
+    static const char *event_names[PERF_EVENT_COUNT] = { "cycles", "instr", "LLC", "dTLB", "br-miss" };
+
+    if (!ctx || !ctx->stats_valid) {
+        return;
+    }
+
+    int perf = ctx->stats_perf;
+    double total = 0;
+
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        if (!phaseRan(ctx, phase)) {
+            continue;
+        }
+
+        // timpul fazei este dat de cel mai lent thread
+        double seconds = 0;
+        uint64_t sums[PERF_EVENT_COUNT] = { 0 };
+        for (int i = 0; i < ctx->noThreads; i++) {
+            phase_stats *st = &ctx->threads[i]->stats[phase];
+
+            if (st->seconds > seconds) {
+                seconds = st->seconds;
+            }
+            for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+                sums[e] += st->counters[e];
+            }
+        }
+        total += seconds;
+
+        fprintf(fp, "%-8s %10.3f ms", phase_names[phase], seconds * 1000);
+        if (perf) {
+            perf_counters *pc = &ctx->threads[0]->perf;
+            double units = ctx->phase_units[phase] ? (double)ctx->phase_units[phase] : 1;
+
+            if (marching_perf_available(pc, PERF_CYCLES) && marching_perf_available(pc, PERF_INSTRUCTIONS) && sums[PERF_CYCLES]) {
+                fprintf(fp, "  IPC %5.2f", (double)sums[PERF_INSTRUCTIONS] / sums[PERF_CYCLES]);
+            } else {
+                fprintf(fp, "  IPC   n/a");
+            }
+            for (int e = PERF_LLC_MISSES; e < PERF_EVENT_COUNT; e++) {
+                if (marching_perf_available(pc, e)) {
+                    fprintf(fp, "  %s/px %8.4f", event_names[e], sums[e] / units);
+                } else {
+                    fprintf(fp, "  %s/px      n/a", event_names[e]);
+                }
+            }
+        }
+        fprintf(fp, "\n");
+
+        if (!perf) {
+            continue;
+        }
+
+        for (int i = 0; i < ctx->noThreads; i++) {
+            phase_stats *st = &ctx->threads[i]->stats[phase];
+            uint64_t cycles = st->counters[PERF_CYCLES];
+
+            fprintf(fp, "  T%-5d %10.3f ms", i, st->seconds * 1000);
+            for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+                if (marching_perf_available(&ctx->threads[i]->perf, e)) {
+                    fprintf(fp, "  %s %llu", event_names[e], (unsigned long long)st->counters[e]);
+                } else {
+                    fprintf(fp, "  %s n/a", event_names[e]);
+                }
+            }
+            if (cycles) {
+                fprintf(fp, "  IPC %.2f", (double)st->counters[PERF_INSTRUCTIONS] / cycles);
+            }
+            fprintf(fp, "\n");
+        }
+    }
+
+    if (ctx->cache_used) {
+        fprintf(fp, "cache: image %s, grid %s (key %016llx)\n", ctx->image_hit ? "hit" : "miss",
+                ctx->grid_hit ? "hit" : "miss", (unsigned long long)ctx->cache_key);
+    }
+
+    if (phaseRan(ctx, PHASE_MARCH)) {
+        uint64_t cells = 0, uniform_cells = 0;
+        for (int i = 0; i < ctx->noThreads; i++) {
+            cells += ctx->threads[i]->cells;
+            uniform_cells += ctx->threads[i]->uniform_cells;
+        }
+        fprintf(fp, "march fast path: %llu of %llu cells (%.1f%%)\n", (unsigned long long)uniform_cells,
+                (unsigned long long)cells, cells ? 100.0 * uniform_cells / cells : 0);
+    }
+
+    fprintf(fp, "%-8s %10.3f ms\n", "total", total * 1000);
+    if (ctx->peak_rss) {
+        fprintf(fp, "peak RSS: %.1f MB, at end of job: %.1f MB\n", ctx->peak_rss / 1024.0, ctx->end_rss / 1024.0);
+    }
+    if (perf && !marching_perf_available(&ctx->threads[0]->perf, PERF_CYCLES)) {
+        fprintf(fp, "perf_event_open unavailable (see /proc/sys/kernel/perf_event_paranoid)\n");
+    }
+}
+
+/*@brief Opreste thread-urile si elibereaza memoria contextului
+ * @param ctx contextul
+*/
+void marching_destroy(marching_context *ctx) {
+    if (!ctx) {
+        return;
+    }
+
+    stopThreads(ctx);
+    freeContext(ctx);
+}
+
+/* @brief Descrierea unui cod de eroare
+ * @param err codul de eroare
+ * @return descrierea
+*/
+const char *marching_strerror(int err) {
+    switch (err) {
+    case MARCHING_OK:
+        return "Success";
+    case MARCHING_ERR_ARGS:
+        return "Invalid arguments";
+    case MARCHING_ERR_NOMEM:
+        return "Unable to allocate memory";
+    case MARCHING_ERR_IO:
+        return "Unable to read or write file";
+    case MARCHING_ERR_FORMAT:
+        return "Invalid image format (must be 'P6' with 8-bits components)";
+    case MARCHING_ERR_THREAD:
+        return "Unable to create threads";
+    case MARCHING_ERR_WORKER:
+        return "Worker process failed";
+    default:
+        return "Unknown error";
+    }
+}
@@ -0,0 +1,122 @@
+#ifndef MARCHING_H
+#define MARCHING_H
+
+// libmarching: algoritmul Marching Squares, paralelizat cu pthreads.
+//
+// Un context pastreaza thread-urile, contururile si buffer-ele de lucru si poate fi refolosit
+// pentru oricate imagini. Functiile nu folosesc stare globala, deci se pot crea mai multe
+// contexte in acelasi proces; apelurile pe acelasi context sunt serializate.
+// Functiile intorc MARCHING_OK sau un cod de eroare negativ si nu opresc procesul.
+
+#include "helpers.h"
+#include <stdio.h>
+#include <stdint.h>
+
+#define MARCHING_OK             0
+#define MARCHING_ERR_ARGS       -1
+#define MARCHING_ERR_NOMEM      -2
+#define MARCHING_ERR_IO         -3
+#define MARCHING_ERR_FORMAT     -4
+#define MARCHING_ERR_THREAD     -5
+#define MARCHING_ERR_WORKER     -6
+
+// Nucleele de esantionare pentru scalare (marching_options.resample)
+#define MARCHING_RESAMPLE_BICUBIC       0
+#define MARCHING_RESAMPLE_BILINEAR      1
+#define MARCHING_RESAMPLE_NEAREST       2
+#define MARCHING_RESAMPLE_AREA          3
+#define MARCHING_RESAMPLE_COUNT         4
+
+// Optiunile unui job
+typedef struct marching_options {
+    int tiled;
+    // scalarea porneste de la o imagine injumatatita (filtru box) de cate ori este posibil
+    // fara sa scada sub dimensiunea de iesire; rezultatul difera de scalarea directa
+    int pyramid;
+    // fazele de scalare, grid si marcare ruleaza pe benzi, fara bariere: o banda se marcheaza
+    // imediat ce grid-ul ei si al benzii urmatoare sunt gata; rezultatul este identic
+    int pipeline;
+    // regiunea de interes: doar celulele care o acopera sunt calculate, iar imaginea de iesire
+    // contine doar regiunea (roi_w x roi_h pixeli). Coordonatele sunt in imaginea de iesire sau,
+    // cu roi_input, in imaginea de intrare. Nu se foloseste cu tiled, pyramid si pipeline.
+    int roi;
+    int roi_input;
+    int roi_x, roi_y, roi_w, roi_h;
+    // daca nu este NULL, imaginea scalata si grid-ul se pastreaza in acest director, cu cheia data
+    // de hash-ul imaginii de intrare si de parametrii scalarii; la o noua rulare pe aceeasi imagine
+    // scalarea este inlocuita de citirea din cache. Nu se foloseste cu roi si pipeline.
+    const char *cache_dir;
+    // dimensiunea maxima a cache-ului, in octeti (0: fara limita); se sterg intrarile cele mai vechi
+    uint64_t cache_limit;
+    // modul cu memorie putina: la sfarsitul job-ului buffer-ele de lucru ale contextului sunt
+    // eliberate in loc sa fie pastrate pentru job-ul urmator
+    int low_memory;
+    // daca nu este NULL, este apelata o singura data in fiecare job, dintr-un thread al contextului,
+    // imediat dupa ultima citire a imaginii de intrare; apelantul poate elibera atunci pixelii ei
+    void (*release_input)(void *arg);
+    void *release_arg;
+    // daca este pozitiv, scalarea este impartita in bucati de atatea linii, luate pe rand de
+    // thread-uri, in loc de cate o banda egala pe thread; rezultatul este identic
+    int rescale_chunk;
+    // nucleul cu care se scaleaza imaginile mari (MARCHING_RESAMPLE_*); implicit bicubic, ca in
+    // varianta secventiala. Celelalte nuclee sunt mai ieftine, dar pot schimba cateva celule.
+    int resample;
+    // dupa job, thread-urile calculeaza o suma de control (XXH64 pe blocuri de 1 MB) a pixelilor
+    // imaginii de iesire, citita cu marching_checksum; nu depinde de numarul de thread-uri
+    int checksum;
+    // doar pentru programe: imaginea de iesire nu se mai scrie in fisier (--checksum-only)
+    int no_output;
+    // numarul de procese pentru marching_squares_sharded (0: thread-urile contextului)
+    int processes;
+    // timpii fiecarei faze, pentru marching_print_stats
+    int stats;
+    // contoare hardware pe faza si thread (implica stats)
+    int perf_counters;
+    // daca nu este NULL, evenimentele fiecarui thread (faze si asteptari la bariera) se scriu
+    // in acest fisier, in formatul Chrome Trace Event
+    const char *trace_file;
+} marching_options;
+
+typedef struct marching_context marching_context;
+
+// Profilul masinii pentru alegerea automata a numarului de thread-uri (marching_autotune).
+// Se obtine o singura data, printr-o calibrare, si se pastreaza intr-un fisier.
+typedef struct {
+    int cores;
+    // ns per pixel de iesire, pe un singur thread: scalarea, respectiv copierea, grid-ul si marcarea
+    double rescale_ns, march_ns;
+    // costul fiecarui thread pornit, in us: crearea, citirea contururilor si barierele unui job
+    double thread_us;
+} marching_profile;
+
+int marching_create(marching_context **ctx, int P, const char *contours_dir);
+int marching_output_size(const ppm_image *in, int *x, int *y);
+int marching_resample_diff(const ppm_image *in, int resample, int pyramid, uint64_t *changed, uint64_t *cells);
+int marching_result_size(const ppm_image *in, const marching_options *opts, int *x, int *y);
+int marching_squares(marching_context *ctx, const ppm_image *in, ppm_image *out, const marching_options *opts);
+int marching_squares_sharded(const char *contours_dir, const ppm_image *in, ppm_image *out, int K, int resample);
+void marching_print_stats(marching_context *ctx, FILE *fp);
+int marching_checksum(marching_context *ctx, uint64_t *checksum);
+int marching_image_checksum(const ppm_image *img, uint64_t *checksum);
+int marching_profile_load(const char *path, const char *contours_dir, marching_profile *profile);
+void marching_autotune(const marching_profile *profile, const ppm_image *in, int *P, int *chunk);
+void marching_destroy(marching_context *ctx);
+const char *marching_strerror(int err);
+
+// O imagine PPM mapata din fisier cu marching_map_ppm; pixelii imaginii sunt in mapare
+typedef struct {
+    ppm_image image;
+    void *addr;
+    size_t size;
+} ppm_mapping;
+
+// Citire / scriere PPM (P6) fara exit la erori. Pixelii imaginilor citite se elibereaza cu free.
+int marching_read_ppm(FILE *fp, ppm_image *img);
+int marching_load_ppm(const char *filename, ppm_image *img);
+int marching_decode_ppm(const void *buf, size_t size, ppm_image *img);
+int marching_write_ppm(FILE *fp, const ppm_image *img);
+int marching_save_ppm(const ppm_image *img, const char *filename);
+int marching_map_ppm(const char *filename, ppm_mapping *m);
+void marching_unmap_ppm(ppm_mapping *m);
+
+#endif
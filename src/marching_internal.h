@@ -0,0 +1,182 @@
+#ifndef MARCHING_INTERNAL_H
+#define MARCHING_INTERNAL_H
+
+// Structurile interne ale libmarching; nu fac parte din API.
+
+#include "marching.h"
+#include "tiled.h"
+#include "resample.h"
+#include "pyramid.h"
+#include "perf.h"
+#include "trace.h"
+#include "hash.h"
+#include "cache.h"
+#include <pthread.h>
+
+#define PATH_MAX_SIZE           4096
+
+// Fazele unui job, pentru statistici
+#define PHASE_HASH              0
+#define PHASE_CACHE             1
+#define PHASE_PYRAMID           2
+#define PHASE_REPACK            3
+#define PHASE_RESCALE           4
+#define PHASE_GRID              5
+#define PHASE_MARCH             6
+#define PHASE_CHECKSUM          7
+#define PHASE_COUNT             8
+
+// Starea pornirii thread-urilor unui context
+#define STARTUP_PENDING         0
+#define STARTUP_RUN             1
+#define STARTUP_ABORT           2
+
+// Versiunea formatului intrarilor din cache; face parte din cheie
+#define CACHE_VERSION           1
+
+// Pipeline (--pipeline): imaginea este impartita in benzi de PIPELINE_BAND linii de celule
+#define PIPELINE_BAND           4
+#define BAND_RESCALED           1
+#define BAND_GRID               2
+
+typedef struct {
+    int ran;
+    double seconds;
+    uint64_t counters[PERF_EVENT_COUNT];
+} phase_stats;
+
+typedef struct thread {
+    int noThreads;
+    int id;
+    int error;
+    unsigned char **grid;
+
+    ppm_image **contur;
+    const ppm_image *image;
+    // imaginea din care se scaleaza: image sau ultimul nivel din piramida
+    const ppm_image *source;
+    ppm_image *levels;
+    int noLevels;
+    ppm_image *scaled_image;
+    tiled_image *tiled_image;
+
+    const marching_options *opts;
+    pthread_barrier_t *barrier;
+    marching_context *ctx;
+
+    // statisticile ultimului job
+    int timed;
+    int perf_opened;
+    perf_counters perf;
+    trace_buffer trace;
+    int chunk_start, chunk_end;
+    uint64_t phase_start;
+    uint64_t phase_counters[PERF_EVENT_COUNT];
+    phase_stats stats[PHASE_COUNT];
+    // celulele marcate de thread si cele umplute direct (contur uniform)
+    uint64_t cells, uniform_cells;
+} thread_structure;
+
+// Thread-urile, contururile si buffer-ele refolosite de la un job la altul
+struct marching_context {
+    int noThreads;
+    pthread_t *tid;
+    thread_structure **threads;
+
+    // serializeaza apelurile marching_squares pe acelasi context
+    pthread_mutex_t lock;
+    // bariera dintre fazele unui job (P thread-uri)
+    pthread_barrier_t barrier;
+    // bariera dintre thread-ul care trimite job-uri si workeri (P + 1 thread-uri)
+    pthread_barrier_t job_barrier;
+    int shutdown;
+    // pornirea thread-urilor: acestea asteapta pana cand toate au fost create (STARTUP_RUN) sau
+    // pana cand crearea unuia a esuat (STARTUP_ABORT), caz in care ies fara sa atinga barierele
+    pthread_mutex_t startup_lock;
+    pthread_cond_t startup_cond;
+    int startup;
+    // contextul nu are thread-uri (P = 0): job-urile ruleaza pe thread-ul apelantului
+    int inline_jobs;
+
+    // planificatorul pipeline-ului: o banda se scaleaza, apoi i se calculeaza grid-ul, apoi se
+    // marcheaza, fara bariere intre faze. Acelasi mutex protejeaza si next_row, urmatoarea linie
+    // de scalat cand scalarea este impartita dinamic (rescale_chunk).
+    pthread_mutex_t pipeline_lock;
+    pthread_cond_t pipeline_cond;
+    int bands;
+    int next_rescale, next_grid, next_march;
+    // benzile 0 ... grid_prefix - 1 au grid-ul calculat
+    int grid_prefix;
+    int rescaled, marched;
+    int next_row;
+    unsigned char *band_state;
+    size_t band_capacity;
+
+    // unitatile de lucru ale fiecarei faze (pixeli sau puncte din grid), pentru valorile per pixel
+    uint64_t phase_units[PHASE_COUNT];
+    int stats_valid;
+    int stats_perf;
+    // varful memoriei rezidente a procesului si memoria rezidenta la sfarsitul job-ului, in KB
+    long peak_rss, end_rss;
+    // imaginea de intrare nu mai este citita in job-ul curent (release_input a fost apelata)
+    int input_released;
+    uint64_t trace_origin;
+
+    const char *contours_dir;
+    ppm_image **contur;
+    // valoarea octetilor unui contur uniform (toti pixelii gri, de aceeasi culoare) sau -1
+    int uniform[CONTOUR_CONFIG_COUNT];
+
+    tiled_image *tiled_image;
+    size_t tiled_capacity;
+    // nivelurile piramidei alterneaza intre doua buffere
+    ppm_image levels[PYRAMID_MAX_LEVELS];
+    ppm_pixel *level_block[2];
+    size_t level_capacity[2];
+    // regiunea de interes (--roi): regiunea in imaginea scalata (coloana, linie, latime, inaltime),
+    // celulele care o acopera (linii [0, 1), coloane [2, 3)), dimensiunea imaginii scalate si
+    // fereastra calculata, aliniata la celule
+    int roi_box[4];
+    int roi_cells[4];
+    int roi_size[2];
+    ppm_image roi_window;
+    size_t roi_capacity;
+    unsigned char **grid;
+    unsigned char *grid_block;
+    int grid_rows;
+    size_t grid_capacity;
+    // cache-ul pe disc (--cache-dir): hash-urile blocurilor imaginii de intrare, cheia job-ului
+    // si intrarile gasite, mapate pana la sfarsitul job-ului
+    int cache_used;
+    uint64_t *hash_blocks;
+    size_t hash_count, hash_capacity;
+    uint64_t cache_key;
+    cache_entry cache_image, cache_grid;
+    int image_hit, grid_hit;
+    // suma de control a imaginii de iesire (--checksum): hash-urile blocurilor ei, calculate de
+    // thread-uri, si rezultatul combinat dupa job
+    uint64_t *checksum_blocks;
+    size_t checksum_count, checksum_capacity;
+    uint64_t checksum;
+    int checksum_valid;
+};
+
+// Functii care lucreaza pe o banda a imaginii, folosite si de modul cu mai multe procese (sharded.c)
+void marching_rescale_pixel(const ppm_image *source, tiled_image *tiled, int resample, int x, int y, int i, int j,
+                            uint8_t sample[]);
+unsigned char marching_grid_point(const ppm_image *in, int resample, int x, int y, int i, int j);
+void marching_rescale_rows(const ppm_image *source, tiled_image *tiled, int resample, ppm_image *out, int start, int end);
+uint64_t marching_march_cells(ppm_image *image, ppm_image **contur, const int *uniform, unsigned char **grid,
+                              int step_x, int step_y, int r0, int r1, int c0, int c1);
+void marching_find_uniform_contours(ppm_image **contur, int uniform[]);
+
+/*@brief Returneaza minimul dintre doua numere
+ * @param a primul numar
+ * @param b al doilea numar
+ * @return minimul dintre a si b
+*/
+static inline int min(int a, int b) {
+    return a < b ? a:b;
+}
+
+#endif
@@ -0,0 +1,168 @@
+#include "options.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+// numele nucleelor de esantionare, in ordinea MARCHING_RESAMPLE_*
+static const char *resample_names[MARCHING_RESAMPLE_COUNT] = { "bicubic", "bilinear", "nearest", "area" };
+
+/* @brief Citeste optiunile aflate dupa argumentele obligatorii (in linia de comanda sau in cererile serverului)
+ * @param argc numarul de argumente
+ * @param argv argumentele
+ * @param first indexul primei optiuni
+ * @param opts optiunile citite
+ * @return 0 daca toate optiunile sunt valide, -1 altfel
+*/
+int parseOptions(int argc, char *argv[], int first, marching_options *opts) {
+    memset(opts, 0, sizeof(marching_options));
+
+    for (int i = first; i < argc; ++i) {
+        if (!strcmp(argv[i], "--tiled")) {
+            opts->tiled = 1;
+        } else if (!strcmp(argv[i], "--pyramid")) {
+            opts->pyramid = 1;
+        } else if (!strcmp(argv[i], "--stats")) {
+            opts->stats = 1;
+        } else if (!strcmp(argv[i], "--perf-counters")) {
+            opts->perf_counters = 1;
+        } else if (!strcmp(argv[i], "--pipeline")) {
+            opts->pipeline = 1;
+        } else if (!strcmp(argv[i], "--processes") && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            opts->processes = atoi(argv[++i]);
+        } else if ((!strcmp(argv[i], "--roi") || !strcmp(argv[i], "--roi-input")) && i + 1 < argc &&
+                   sscanf(argv[i + 1], "%d,%d,%d,%d", &opts->roi_x, &opts->roi_y, &opts->roi_w, &opts->roi_h) == 4) {
+            opts->roi = 1;
+            opts->roi_input = !strcmp(argv[i], "--roi-input");
+            i++;
+        } else if (!strcmp(argv[i], "--cache-dir") && i + 1 < argc) {
+            opts->cache_dir = argv[++i];
+        } else if (!strcmp(argv[i], "--cache-size") && i + 1 < argc && atoll(argv[i + 1]) > 0) {
+            // in MB
+            opts->cache_limit = (uint64_t)atoll(argv[++i]) << 20;
+        } else if (!strcmp(argv[i], "--rescale-chunk") && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            opts->rescale_chunk = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--resample") && i + 1 < argc && parseResample(argv[i + 1]) >= 0) {
+            opts->resample = parseResample(argv[++i]);
+        } else if (!strcmp(argv[i], "--checksum")) {
+            opts->checksum = 1;
+        } else if (!strcmp(argv[i], "--checksum-only")) {
+            opts->checksum = 1;
+            opts->no_output = 1;
+        } else if (!strcmp(argv[i], "--low-memory")) {
+            opts->low_memory = 1;
+        } else if (!strcmp(argv[i], "--trace") && i + 1 < argc) {
+            opts->trace_file = argv[++i];
+        } else {
+            fprintf(stderr, "Unknown option '%s'\n", argv[i]);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* @brief Verifica daca optiunile citite pot fi folosite impreuna
+ * @param opts optiunile
+ * @return mesajul de eroare sau NULL daca optiunile sunt compatibile
+*/
+const char *checkOptions(const marching_options *opts) {
+    // modul cu procese (marching_squares_sharded) primeste doar nucleul de esantionare; suma de
+    // control este calculata de apelant din imaginea de iesire
+    if (opts->processes) {
+        if (opts->roi) {
+            return "--processes cannot be combined with --roi";
+        }
+        if (opts->tiled || opts->pyramid || opts->pipeline || opts->rescale_chunk) {
+            return "--processes cannot be combined with --tiled, --pyramid, --pipeline or --rescale-chunk";
+        }
+        if (opts->cache_dir || opts->cache_limit || opts->low_memory) {
+            return "--processes cannot be combined with --cache-dir, --cache-size or --low-memory";
+        }
+        if (opts->stats || opts->perf_counters || opts->trace_file) {
+            return "--processes cannot be combined with --stats, --perf-counters or --trace";
+        }
+    }
+
+    // regiunea de interes este scalata direct din imaginea de intrare, dupa ce toata fereastra ei
+    // este calculata
+    if (opts->roi && (opts->tiled || opts->pyramid || opts->pipeline)) {
+        return "--roi cannot be combined with --tiled, --pyramid or --pipeline";
+    }
+
+    return NULL;
+}
+
+/* @brief Elibereaza pixelii imaginii de intrare imediat ce job-ul nu mai are nevoie de ei
+ * (marching_options.release_input, cu --low-memory)
+ * @param arg imaginea de intrare
+*/
+void releaseImage(void *arg) {
+    ppm_image *image = (ppm_image *)arg;
+
+    free(image->data);
+    image->data = NULL;
+}
+
+/* @brief Citeste numarul de thread-uri: un numar pozitiv sau "auto"
+ * @param arg argumentul
+ * @param P numarul citit, THREADS_AUTO pentru "auto"
+ * @return 0 daca argumentul este valid, -1 altfel
+*/
+int parseThreads(const char *arg, int *P) {
+    char *end;
+
+    if (!strcmp(arg, "auto")) {
+        *P = THREADS_AUTO;
+        return 0;
+    }
+
+    errno = 0;
+    long value = strtol(arg, &end, 10);
+    if (errno || end == arg || *end || value <= 0 || value > THREADS_MAX) {
+        return -1;
+    }
+
+    *P = (int)value;
+    return 0;
+}
+
+/* @brief Calea fisierului de profil pentru modul automat: $MARCHING_PROFILE, altfel
+ * ~/.marching_profile, altfel ./.marching_profile
+ * @param path calea
+ * @param size dimensiunea buffer-ului
+*/
+void profilePath(char *path, size_t size) {
+    const char *env = getenv("MARCHING_PROFILE");
+    const char *home = getenv("HOME");
+
+    if (env && *env) {
+        snprintf(path, size, "%s", env);
+    } else if (home && *home) {
+        snprintf(path, size, "%s/.marching_profile", home);
+    } else {
+        snprintf(path, size, "./.marching_profile");
+    }
+}
+
+/* @brief Citeste numele unui nucleu de esantionare
+ * @param name numele (bicubic, bilinear, nearest sau area)
+ * @return nucleul (MARCHING_RESAMPLE_*) sau -1 daca numele nu este cunoscut
+*/
+int parseResample(const char *name) {
+    for (int i = 0; i < MARCHING_RESAMPLE_COUNT; i++) {
+        if (!strcmp(name, resample_names[i])) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/* @brief Numele unui nucleu de esantionare
+ * @param resample nucleul (MARCHING_RESAMPLE_*)
+ * @return numele
+*/
+const char *resampleName(int resample) {
+    return resample >= 0 && resample < MARCHING_RESAMPLE_COUNT ? resample_names[resample] : "unknown";
+}
@@ -0,0 +1,19 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "marching.h"
+#include <stddef.h>
+
+// P = "auto": numarul de thread-uri este ales de marching_autotune
+#define THREADS_AUTO            -1
+#define THREADS_MAX             1024
+
+int parseOptions(int argc, char *argv[], int first, marching_options *opts);
+const char *checkOptions(const marching_options *opts);
+void releaseImage(void *arg);
+int parseThreads(const char *arg, int *P);
+void profilePath(char *path, size_t size);
+int parseResample(const char *name);
+const char *resampleName(int resample);
+
+#endif
@@ -0,0 +1,77 @@
+#include "perf.h"
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/* @brief Deschide un contor pentru thread-ul curent (doar user space)
+ * @param type tipul evenimentului
+ * @param config evenimentul
+ * @return descriptorul contorului sau -1 daca nu este disponibil
+*/
+static int openEvent(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/* @brief Deschide contoarele pentru thread-ul curent. Contoarele care nu sunt suportate
+ * (sau nu sunt permise de perf_event_paranoid) raman indisponibile.
+ * @param pc contoarele
+*/
+void marching_perf_open(perf_counters *pc) {
+    pc->fds[PERF_CYCLES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    pc->fds[PERF_INSTRUCTIONS] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    pc->fds[PERF_LLC_MISSES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    pc->fds[PERF_DTLB_MISSES] = openEvent(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+                                          (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    pc->fds[PERF_BRANCH_MISSES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+}
+
+/* @brief Citeste valorile curente ale contoarelor. Daca un contor a fost multiplexat,
+ * valoarea este extrapolata la tot intervalul in care a fost activ.
+ * @param pc contoarele
+ * @param values valorile citite (0 pentru contoarele indisponibile)
+*/
+void marching_perf_read(perf_counters *pc, uint64_t values[]) {
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        uint64_t data[3];
+
+        values[i] = 0;
+        if (pc->fds[i] < 0 || read(pc->fds[i], data, sizeof(data)) != sizeof(data) || !data[2]) {
+            continue;
+        }
+
+        values[i] = data[1] == data[2] ? data[0] : (uint64_t)((double)data[0] * data[1] / data[2]);
+    }
+}
+
+/* @brief Verifica daca un contor a putut fi deschis
+ * @param pc contoarele
+ * @param event contorul
+ * @return 1 daca este disponibil, 0 altfel
+*/
+int marching_perf_available(perf_counters *pc, int event) {
+    return pc->fds[event] >= 0;
+}
+
+/* @brief Inchide contoarele
+ * @param pc contoarele
+*/
+void marching_perf_close(perf_counters *pc) {
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        if (pc->fds[i] >= 0) {
+            close(pc->fds[i]);
+        }
+        pc->fds[i] = -1;
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef PERF_H
+#define PERF_H
+
+// Contoare hardware citite cu perf_event_open pentru thread-ul curent
+
+#include <stdint.h>
+
+#define PERF_CYCLES             0
+#define PERF_INSTRUCTIONS       1
+#define PERF_LLC_MISSES         2
+#define PERF_DTLB_MISSES        3
+#define PERF_BRANCH_MISSES      4
+#define PERF_EVENT_COUNT        5
+
+typedef struct {
+    int fds[PERF_EVENT_COUNT];
+} perf_counters;
+
+void marching_perf_open(perf_counters *pc);
+void marching_perf_read(perf_counters *pc, uint64_t values[]);
+int marching_perf_available(perf_counters *pc, int event);
+void marching_perf_close(perf_counters *pc);
+
+#endif
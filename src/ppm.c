@@ -0,0 +1,229 @@
+// Citire si scriere PPM pentru libmarching. Formatul este acelasi ca in read_ppm / write_ppm
+// din helpers.c, dar erorile sunt intoarse ca cod in loc sa opreasca procesul.
+
+#include "marching.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* @brief Citeste antetul unei imagini PPM; stream-ul ramane pozitionat la primul pixel
+ * @param fp stream-ul
+ * @param x latimea citita
+ * @param y inaltimea citita
+ * @return MARCHING_OK sau MARCHING_ERR_FORMAT
+*/
+static int readHeader(FILE *fp, int *x, int *y) {
+    char buff[16];
+    int c, rgb_comp_color;
+
+    // read image format
+    if (!fgets(buff, sizeof(buff), fp) || buff[0] != 'P' || buff[1] != '6') {
+        return MARCHING_ERR_FORMAT;
+    }
+
+    // check for comments
+    c = getc(fp);
+    while (c == '#') {
+        while ((c = getc(fp)) != '\n' && c != EOF);
+
+        c = getc(fp);
+    }
+
+    ungetc(c, fp);
+
+    // read image size information
+    if (fscanf(fp, "%d %d", x, y) != 2 || *x <= 0 || *y <= 0 || (size_t)*x * *y > SIZE_MAX / sizeof(ppm_pixel)) {
+        return MARCHING_ERR_FORMAT;
+    }
+
+    // read RGB component
+    if (fscanf(fp, "%d", &rgb_comp_color) != 1 || rgb_comp_color != RGB_COMPONENT_COLOR) {
+        return MARCHING_ERR_FORMAT;
+    }
+
+    while ((c = fgetc(fp)) != '\n' && c != EOF) ;
+
+    return MARCHING_OK;
+}
+
+/* @brief Citeste o imagine PPM dintr-un stream
+ * @param fp stream-ul
+ * @param img imaginea citita; pixelii sunt alocati cu malloc
+ * @return MARCHING_OK sau un cod de eroare
+*/
+int marching_read_ppm(FILE *fp, ppm_image *img) {
+    int x, y;
+
+    int err = readHeader(fp, &x, &y);
+    if (err) {
+        return err;
+    }
+
+    // memory allocation for pixel data
+    ppm_pixel *data = (ppm_pixel *)malloc((size_t)x * y * sizeof(ppm_pixel));
+    if (!data) {
+        return MARCHING_ERR_NOMEM;
+    }
+
+    // read pixel data from file
+    size_t pixels = (size_t)x * y;
+    if (fread(data, sizeof(ppm_pixel), pixels, fp) != pixels) {
+        free(data);
+        return MARCHING_ERR_FORMAT;
+    }
+
+    img->x = x;
+    img->y = y;
+    img->data = data;
+
+    return MARCHING_OK;
+}
+
+/* @brief Citeste o imagine PPM dintr-un fisier
+ * @param filename calea fisierului
+ * @param img imaginea citita
+ * @return MARCHING_OK sau un cod de eroare
+*/
+int marching_load_ppm(const char *filename, ppm_image *img) {
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) {
+        return MARCHING_ERR_IO;
+    }
+
+    int err = marching_read_ppm(fp, img);
+    fclose(fp);
+
+    return err;
+}
+
+/* @brief Mapeaza in memorie (doar pentru citire) o imagine PPM; pixelii nu sunt copiati, iar
+ * paginile sunt citite din fisier la prima folosire. Pixelii imaginii nu trebuie modificati.
+ * @param filename calea fisierului
+ * @param m maparea; m->image este imaginea citita
+ * @return MARCHING_OK sau un cod de eroare
+*/
+int marching_map_ppm(const char *filename, ppm_mapping *m) {
+    struct stat st;
+    int x, y;
+
+    m->addr = NULL;
+    m->size = 0;
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return MARCHING_ERR_IO;
+    }
+    if (fstat(fd, &st) || !st.st_size) {
+        close(fd);
+        return MARCHING_ERR_FORMAT;
+    }
+
+    void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return MARCHING_ERR_IO;
+    }
+
+    // antetul este citit cu aceleasi reguli ca in marching_read_ppm
+    FILE *fp = fmemopen(addr, st.st_size, "rb");
+    if (!fp) {
+        munmap(addr, st.st_size);
+        return MARCHING_ERR_NOMEM;
+    }
+    int err = readHeader(fp, &x, &y);
+    long offset = ftell(fp);
+    fclose(fp);
+
+    if (!err && (offset < 0 || (size_t)(st.st_size - offset) < (size_t)x * y * sizeof(ppm_pixel))) {
+        err = MARCHING_ERR_FORMAT;
+    }
+    if (err) {
+        munmap(addr, st.st_size);
+        return err;
+    }
+
+    m->addr = addr;
+    m->size = st.st_size;
+    m->image.x = x;
+    m->image.y = y;
+    m->image.data = (ppm_pixel *)((unsigned char *)addr + offset);
+
+    return MARCHING_OK;
+}
+
+/* @brief Elibereaza maparea unei imagini; poate fi apelata de mai multe ori
+ * @param m maparea
+*/
+void marching_unmap_ppm(ppm_mapping *m) {
+    if (m->addr) {
+        munmap(m->addr, m->size);
+    }
+    m->addr = NULL;
+    m->size = 0;
+    m->image.data = NULL;
+}
+
+/* @brief Citeste o imagine PPM dintr-un buffer aflat in memorie
+ * @param buf continutul fisierului PPM
+ * @param size dimensiunea buffer-ului
+ * @param img imaginea citita
+ * @return MARCHING_OK sau un cod de eroare
+*/
+int marching_decode_ppm(const void *buf, size_t size, ppm_image *img) {
+    if (!buf || !size) {
+        return MARCHING_ERR_ARGS;
+    }
+
+    FILE *fp = fmemopen((void *)buf, size, "rb");
+    if (!fp) {
+        return MARCHING_ERR_NOMEM;
+    }
+
+    int err = marching_read_ppm(fp, img);
+    fclose(fp);
+
+    return err;
+}
+
+/* @brief Scrie o imagine PPM intr-un stream
+ * @param fp stream-ul
+ * @param img imaginea
+ * @return MARCHING_OK sau MARCHING_ERR_IO
+*/
+int marching_write_ppm(FILE *fp, const ppm_image *img) {
+    // the header file image format, image size and RGB component depth
+    if (fprintf(fp, "P6\n%d %d\n%d\n", img->x, img->y, RGB_COMPONENT_COLOR) < 0) {
+        return MARCHING_ERR_IO;
+    }
+
+    // pixel data
+    size_t pixels = (size_t)img->x * img->y;
+    if (fwrite(img->data, sizeof(ppm_pixel), pixels, fp) != pixels) {
+        return MARCHING_ERR_IO;
+    }
+
+    return MARCHING_OK;
+}
+
+/* @brief Scrie o imagine PPM intr-un fisier
+ * @param img imaginea
+ * @param filename calea fisierului
+ * @return MARCHING_OK sau MARCHING_ERR_IO
+*/
+int marching_save_ppm(const ppm_image *img, const char *filename) {
+    FILE *fp = fopen(filename, "wb");
+    if (!fp) {
+        return MARCHING_ERR_IO;
+    }
+
+    int err = marching_write_ppm(fp, img);
+    if (fclose(fp) && !err) {
+        err = MARCHING_ERR_IO;
+    }
+
+    return err;
+}
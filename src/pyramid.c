@@ -0,0 +1,63 @@
+#include "pyramid.h"
+
+/* @brief Calculeaza cate niveluri se construiesc: se injumatateste cat timp nivelul urmator
+ * ramane cel putin cat imaginea tinta pe ambele axe
+ * @param x latimea sursei
+ * @param y inaltimea sursei
+ * @param target_x latimea imaginii tinta
+ * @param target_y inaltimea imaginii tinta
+ * @return numarul de niveluri (0 daca sursa nu este de cel putin 2 ori mai mare)
+*/
+int marching_pyramid_levels(int x, int y, int target_x, int target_y) {
+    int levels = 0;
+
+    while (levels < PYRAMID_MAX_LEVELS && (x + 1) / 2 >= target_x && (y + 1) / 2 >= target_y) {
+        x = (x + 1) / 2;
+        y = (y + 1) / 2;
+        levels++;
+    }
+
+    return levels;
+}
+
+/* @brief Calculeaza liniile [start, end) ale nivelului urmator. Fiecare pixel este media
+ * (rotunjita) unui bloc de 2x2 pixeli din sursa; pe ultima linie / coloana a unei surse
+ * cu dimensiune impara blocul este repetat la margine. Sursa este citita secvential,
+ * doua linii odata, iar bucla interioara lucreaza pe octeti, fara ramificatii.
+ * @param source nivelul curent (row-major)
+ * @param dest nivelul urmator, de ((source->x + 1) / 2) x ((source->y + 1) / 2) pixeli
+ * @param start prima linie din dest
+ * @param end linia de dupa ultima
+*/
+void marching_decimate_rows(const ppm_image *source, ppm_image *dest, int start, int end) {
+    const unsigned char *src = (const unsigned char *)source->data;
+    unsigned char *dst = (unsigned char *)dest->data;
+    size_t src_row = 3 * (size_t)source->x;
+    size_t dst_row = 3 * (size_t)dest->x;
+    int pairs = source->x / 2;
+
+    for (int y = start; y < end; y++) {
+        const unsigned char *r0 = src + src_row * (2 * (size_t)y);
+        const unsigned char *r1 = 2 * y + 1 < source->y ? r0 + src_row : r0;
+        unsigned char *out = dst + dst_row * y;
+
+        for (int k = 0; k < 3 * pairs; k += 3) {
+            const unsigned char *a = r0 + 2 * k;
+            const unsigned char *b = r1 + 2 * k;
+
+            out[k] = (unsigned char)((a[0] + a[3] + b[0] + b[3] + 2) >> 2);
+            out[k + 1] = (unsigned char)((a[1] + a[4] + b[1] + b[4] + 2) >> 2);
+            out[k + 2] = (unsigned char)((a[2] + a[5] + b[2] + b[5] + 2) >> 2);
+        }
+
+        // coloana ramasa a unei surse cu latime impara
+        if (source->x & 1) {
+            const unsigned char *a = r0 + src_row - 3;
+            const unsigned char *b = r1 + src_row - 3;
+
+            for (int c = 0; c < 3; c++) {
+                out[3 * pairs + c] = (unsigned char)((a[c] + b[c] + 1) >> 1);
+            }
+        }
+    }
+}
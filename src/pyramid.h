@@ -0,0 +1,14 @@
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#include "helpers.h"
+
+// Piramida de imagini injumatatite (mip levels), folosita inainte de scalarea imaginilor
+// mult mai mari decat imaginea de iesire. Fiecare nivel are jumatate din latimea si
+// inaltimea nivelului anterior (rotunjit in sus) si este obtinut cu un filtru box 2x2.
+#define PYRAMID_MAX_LEVELS      16
+
+int marching_pyramid_levels(int x, int y, int target_x, int target_y);
+void marching_decimate_rows(const ppm_image *source, ppm_image *dest, int start, int end);
+
+#endif
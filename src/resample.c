@@ -0,0 +1,159 @@
+#include "resample.h"
+#include <math.h>
+
+#define CLAMP(v, min, max) if(v < min) { v = min; } else if(v > max) { v = max; }
+
+/* @brief Intoarce pixelul (x, y), cu coordonatele limitate la imagine (ca get_pixel_clamped)
+ * @param img imaginea
+ * @param x coloana
+ * @param y linia
+*/
+static inline const ppm_pixel *pixelClamped(const ppm_image *img, int x, int y) {
+    CLAMP(x, 0, img->x - 1);
+    CLAMP(y, 0, img->y - 1);
+
+    return &img->data[x + (size_t)img->x * y];
+}
+
+/* @brief Polinomul Hermite cubic prin A, B, C, D, evaluat in t (ca cubic_hermite din helpers.c)
+ * @param A primul punct
+ * @param B al doilea punct
+ * @param C al treilea punct
+ * @param D al patrulea punct
+ * @param t pozitia dintre B si C
+*/
+float marching_cubic_hermite(float A, float B, float C, float D, float t) {
+    float a = -A / 2.0f + (3.0f * B) / 2.0f - (3.0f * C) / 2.0f + D / 2.0f;
+    float b = A - (5.0f * B) / 2.0f + 2.0f * C - D / 2.0f;
+    float c = -A / 2.0f + C / 2.0f;
+    float d = B;
+
+    return a * t * t * t + b * t * t + c * t + d;
+}
+
+/* @brief Interpoleaza bicubic cei 4x4 pixeli din jurul punctului (u, v). Acelasi calcul ca
+ * sample_bicubic din helpers.c, deci rezultatul este identic bit cu bit; helpers.c nu face parte
+ * din biblioteca, pentru ca read_ppm / write_ppm apeleaza exit.
+ * @param source_image imaginea sursa
+ * @param u coordonata normalizata pe x
+ * @param v coordonata normalizata pe y
+ * @param sample culoarea calculata
+*/
+void marching_sample_bicubic(const ppm_image *source_image, float u, float v, uint8_t sample[]) {
+    float x = (u * source_image->x) - 0.5;
+    int xint = (int)x;
+    float xfract = x - floor(x);
+
+    float y = (v * source_image->y) - 0.5;
+    int yint = (int)y;
+    float yfract = y - floor(y);
+
+    // p[linie][coloana]
+    const ppm_pixel *p[4][4];
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            p[i][j] = pixelClamped(source_image, xint - 1 + j, yint - 1 + i);
+        }
+    }
+
+    for (int i = 0; i < 3; i++) {
+        float col[4];
+
+        for (int k = 0; k < 4; k++) {
+            col[k] = marching_cubic_hermite((&p[k][0]->red)[i], (&p[k][1]->red)[i], (&p[k][2]->red)[i],
+                                            (&p[k][3]->red)[i], xfract);
+        }
+
+        float value = marching_cubic_hermite(col[0], col[1], col[2], col[3], yfract);
+
+        CLAMP(value, 0.0f, 255.0f);
+        sample[i] = (uint8_t)value;
+    }
+}
+
+/* @brief Esantioneaza pixelul cel mai apropiat de punctul (u, v)
+ * @param source_image imaginea sursa
+ * @param u coordonata normalizata pe x
+ * @param v coordonata normalizata pe y
+ * @param sample culoarea calculata
+*/
+void marching_sample_nearest(const ppm_image *source_image, float u, float v, uint8_t sample[]) {
+    // pixelul care contine punctul este cel al carui centru (k + 0.5) este cel mai apropiat
+    int x = (int)floor(u * source_image->x);
+    int y = (int)floor(v * source_image->y);
+    const ppm_pixel *p = pixelClamped(source_image, x, y);
+
+    sample[0] = p->red;
+    sample[1] = p->green;
+    sample[2] = p->blue;
+}
+
+/* @brief Interpoleaza biliniar cei 2x2 pixeli din jurul punctului (u, v)
+ * @param source_image imaginea sursa
+ * @param u coordonata normalizata pe x
+ * @param v coordonata normalizata pe y
+ * @param sample culoarea calculata
+*/
+void marching_sample_bilinear(const ppm_image *source_image, float u, float v, uint8_t sample[]) {
+    float x = (u * source_image->x) - 0.5;
+    int xint = (int)floor(x);
+    float xfract = x - xint;
+
+    float y = (v * source_image->y) - 0.5;
+    int yint = (int)floor(y);
+    float yfract = y - yint;
+
+    const ppm_pixel *p00 = pixelClamped(source_image, xint, yint);
+    const ppm_pixel *p10 = pixelClamped(source_image, xint + 1, yint);
+    const ppm_pixel *p01 = pixelClamped(source_image, xint, yint + 1);
+    const ppm_pixel *p11 = pixelClamped(source_image, xint + 1, yint + 1);
+
+    const unsigned char *c00 = &p00->red, *c10 = &p10->red, *c01 = &p01->red, *c11 = &p11->red;
+    for (int i = 0; i < 3; i++) {
+        float row0 = c00[i] + (c10[i] - c00[i]) * xfract;
+        float row1 = c01[i] + (c11[i] - c01[i]) * xfract;
+        float value = row0 + (row1 - row0) * yfract;
+
+        // ca la marching_sample_bicubic, valoarea este trunchiata
+        CLAMP(value, 0.0f, 255.0f);
+        sample[i] = (uint8_t)value;
+    }
+}
+
+/* @brief Face media pixelilor sursei acoperiti de un pixel de iesire centrat in (u, v), de
+ * dimensiune du x dv pixeli din sursa (filtru box). Cel putin un pixel este citit.
+ * @param source_image imaginea sursa
+ * @param u coordonata normalizata pe x
+ * @param v coordonata normalizata pe y
+ * @param du latimea pixelului de iesire, in pixeli din sursa
+ * @param dv inaltimea pixelului de iesire, in pixeli din sursa
+ * @param sample culoarea calculata
+*/
+void marching_sample_area(const ppm_image *source_image, float u, float v, float du, float dv, uint8_t sample[]) {
+    float cx = u * source_image->x;
+    float cy = v * source_image->y;
+
+    // pixelii ale caror centre (k + 0.5) cad in [c - d / 2, c + d / 2)
+    int x0 = (int)ceil(cx - du / 2 - 0.5), x1 = (int)ceil(cx + du / 2 - 0.5);
+    int y0 = (int)ceil(cy - dv / 2 - 0.5), y1 = (int)ceil(cy + dv / 2 - 0.5);
+    CLAMP(x0, 0, source_image->x - 1);
+    CLAMP(y0, 0, source_image->y - 1);
+    CLAMP(x1, x0 + 1, source_image->x);
+    CLAMP(y1, y0 + 1, source_image->y);
+
+    unsigned int sum[3] = { 0, 0, 0 };
+    for (int y = y0; y < y1; y++) {
+        const ppm_pixel *row = &source_image->data[(size_t)source_image->x * y];
+
+        for (int x = x0; x < x1; x++) {
+            sum[0] += row[x].red;
+            sum[1] += row[x].green;
+            sum[2] += row[x].blue;
+        }
+    }
+
+    unsigned int count = (unsigned int)(x1 - x0) * (y1 - y0);
+    for (int i = 0; i < 3; i++) {
+        sample[i] = (uint8_t)((sum[i] + count / 2) / count);
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+
+#include "helpers.h"
+
+// Nucleele de esantionare ale bibliotecii. marching_sample_bicubic este copia lui sample_bicubic
+// din helpers.c (nucleul implicit), iar celelalte sunt alternative la el. Toate primesc aceleasi
+// coordonate normalizate (u, v) si folosesc aceeasi conventie pentru centrul pixelilor, deci
+// difera doar vecinatatea citita si ponderile:
+//   bicubic   4x4 pixeli
+//   nearest   1 pixel, cel mai apropiat
+//   bilinear  2x2 pixeli
+//   area      media pixelilor acoperiti de pixelul de iesire (du x dv pixeli din sursa)
+float marching_cubic_hermite(float A, float B, float C, float D, float t);
+void marching_sample_bicubic(const ppm_image *source_image, float u, float v, uint8_t sample[]);
+void marching_sample_nearest(const ppm_image *source_image, float u, float v, uint8_t sample[]);
+void marching_sample_bilinear(const ppm_image *source_image, float u, float v, uint8_t sample[]);
+void marching_sample_area(const ppm_image *source_image, float u, float v, float du, float dv, uint8_t sample[]);
+
+#endif
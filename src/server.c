@@ -0,0 +1,410 @@
+#include "server.h"
+#include "marching.h"
+#include "options.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#define REQUEST_MAX_SIZE        4096
+#define REQUEST_MAX_ARGS        32
+// conexiunile deschise simultan; fiecare are un thread care citeste cererile si imaginile ei
+#define CLIENTS_MAX             64
+// o conexiune care nu trimite nimic atatea secunde este inchisa
+#define CLIENT_TIMEOUT          30
+
+// Starea comuna a thread-urilor conexiunilor
+typedef struct {
+    marching_context *ctx;
+    // profilul masinii cu P = "auto", altfel NULL
+    const marching_profile *profile;
+    // job-urile pe context (si citirea statisticilor si a sumei de control) ruleaza pe rand;
+    // citirea cererilor si a imaginilor, respectiv scrierea rezultatelor nu tin lock-ul
+    pthread_mutex_t job_lock;
+    // conexiunile deschise, ca la oprire sa fie inchise si asteptate
+    pthread_mutex_t clients_lock;
+    pthread_cond_t clients_cond;
+    int clients[CLIENTS_MAX];
+    int noClients;
+} server_state;
+
+typedef struct {
+    server_state *server;
+    int fd;
+} client_connection;
+
+static volatile sig_atomic_t stop_requested;
+
+static void onSignal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+/* @brief Pregateste buffer-ul imaginii de iesire. Buffer-ul este pastrat intre job-uri si
+ * realocat doar cand o imagine are nevoie de mai mult spatiu.
+ * @param out imaginea de iesire
+ * @param capacity numarul de pixeli alocati
+ * @param x latimea imaginii de iesire
+ * @param y inaltimea imaginii de iesire
+ * @return 0 la succes, -1 daca nu exista memorie
+*/
+static int reserveOutput(ppm_image *out, size_t *capacity, int x, int y) {
+    size_t pixels = (size_t)x * y;
+
+    if (*capacity < pixels) {
+        free(out->data);
+        *capacity = 0;
+        out->data = (ppm_pixel *)malloc(pixels * sizeof(ppm_pixel));
+        if (!out->data) {
+            return -1;
+        }
+        *capacity = pixels;
+    }
+
+    out->x = x;
+    out->y = y;
+
+    return 0;
+}
+
+/* @brief Executa un job primit pe conexiune si trimite raspunsul
+ * @param server starea serverului
+ * @param result buffer-ul imaginii de iesire, refolosit intre job-urile conexiunii
+ * @param capacity numarul de pixeli alocati in result
+ * @param line linia cererii
+ * @param in stream-ul din care se citeste imaginea, daca este trimisa pe conexiune
+ * @param out stream-ul pe care se trimite raspunsul
+ * @return 0 daca raspunsul a fost trimis, -1 daca conexiunea trebuie inchisa
+*/
+static int handleJob(server_state *server, ppm_image *result, size_t *capacity, char *line, FILE *in, FILE *out) {
+    char *argv[REQUEST_MAX_ARGS];
+    char *saveptr;
+    int argc = 0;
+    int err;
+
+    for (char *tok = strtok_r(line, " \t\r\n", &saveptr); tok && argc < REQUEST_MAX_ARGS;
+         tok = strtok_r(NULL, " \t\r\n", &saveptr)) {
+        argv[argc++] = tok;
+    }
+
+    if (argc < 2) {
+        return fprintf(out, "ERR Usage: <in_file|-> <out_file|-> [options]\n") < 0 ? -1 : 0;
+    }
+
+    // cu o imagine trimisa pe conexiune, o imagine invalida desincronizeaza stream-ul
+    ppm_image image;
+    if (!strcmp(argv[0], "-")) {
+        err = marching_read_ppm(in, &image);
+        if (err) {
+            fprintf(out, "ERR %s\n", marching_strerror(err));
+            return -1;
+        }
+    } else {
+        err = marching_load_ppm(argv[0], &image);
+        if (err) {
+            return fprintf(out, "ERR '%s': %s\n", argv[0], marching_strerror(err)) < 0 ? -1 : 0;
+        }
+    }
+
+    marching_options opts;
+    const char *invalid = NULL;
+    int x, y;
+    if (parseOptions(argc, argv, 2, &opts)) {
+        err = MARCHING_ERR_ARGS;
+    } else if ((invalid = checkOptions(&opts))) {
+        free(image.data);
+        return fprintf(out, "ERR %s\n", invalid) < 0 ? -1 : 0;
+    } else if (marching_result_size(&image, &opts, &x, &y)) {
+        err = MARCHING_ERR_ARGS;
+    } else {
+        err = reserveOutput(result, capacity, x, y) ? MARCHING_ERR_NOMEM : MARCHING_OK;
+    }
+
+    uint64_t checksum = 0;
+    if (!err) {
+        if (opts.processes) {
+            err = marching_squares_sharded(NULL, &image, result, opts.processes, opts.resample);
+            if (!err && opts.checksum) {
+                err = marching_image_checksum(result, &checksum);
+            }
+        } else {
+            if (opts.low_memory) {
+                opts.release_input = releaseImage;
+                opts.release_arg = &image;
+            }
+            // cu "auto" bucatile de scalare sunt alese dupa imagine, ca in tema1_par
+            if (server->profile && !opts.rescale_chunk) {
+                int job_threads;
+                marching_autotune(server->profile, &image, &job_threads, &opts.rescale_chunk);
+            }
+
+            pthread_mutex_lock(&server->job_lock);
+            err = marching_squares(server->ctx, &image, result, &opts);
+            marching_print_stats(server->ctx, stderr);
+            if (!err && opts.checksum) {
+                err = marching_checksum(server->ctx, &checksum);
+            }
+            pthread_mutex_unlock(&server->job_lock);
+        }
+    }
+    free(image.data);
+
+    if (err) {
+        return fprintf(out, "ERR %s\n", marching_strerror(err)) < 0 ? -1 : 0;
+    }
+
+    // cu --checksum suma de control este adaugata la raspuns
+    char sum[24] = "";
+    if (opts.checksum) {
+        snprintf(sum, sizeof(sum), " %016llx", (unsigned long long)checksum);
+    }
+
+    // cu --checksum-only imaginea nu este nici scrisa, nici trimisa
+    if (opts.no_output) {
+        return fprintf(out, "OK 0%s\n", sum) < 0 ? -1 : 0;
+    }
+
+    if (!strcmp(argv[1], "-")) {
+        char header[64];
+        int header_size = snprintf(header, sizeof(header), "P6\n%d %d\n%d\n", result->x, result->y, RGB_COMPONENT_COLOR);
+        size_t size = header_size + (size_t)result->x * result->y * sizeof(ppm_pixel);
+
+        if (fprintf(out, "OK %zu%s\n", size, sum) < 0 || marching_write_ppm(out, result)) {
+            return -1;
+        }
+        return 0;
+    }
+
+    err = marching_save_ppm(result, argv[1]);
+    if (err) {
+        return fprintf(out, "ERR '%s': %s\n", argv[1], marching_strerror(err)) < 0 ? -1 : 0;
+    }
+
+    return fprintf(out, "OK 0%s\n", sum) < 0 ? -1 : 0;
+}
+
+/* @brief Serveste job-urile trimise pe o conexiune pana cand clientul o inchide, nu mai trimite
+ * nimic timp de CLIENT_TIMEOUT secunde sau serverul este oprit
+ * @param server starea serverului
+ * @param fd conexiunea
+*/
+static void handleClient(server_state *server, int fd) {
+    int out_fd = dup(fd);
+    FILE *in = fdopen(fd, "rb");
+    FILE *out = out_fd < 0 ? NULL : fdopen(out_fd, "wb");
+
+    if (!in || !out) {
+        if (in) {
+            fclose(in);
+        } else {
+            close(fd);
+        }
+        if (out) {
+            fclose(out);
+        } else if (out_fd >= 0) {
+            close(out_fd);
+        }
+        return;
+    }
+
+    ppm_image result = { 0, 0, NULL };
+    size_t capacity = 0;
+    char line[REQUEST_MAX_SIZE];
+    while (!stop_requested && fgets(line, sizeof(line), in)) {
+        if (handleJob(server, &result, &capacity, line, in, out) || fflush(out)) {
+            break;
+        }
+    }
+
+    free(result.data);
+    fclose(in);
+    fclose(out);
+}
+
+/* @brief Scoate o conexiune din lista conexiunilor deschise
+ * @param server starea serverului
+ * @param fd conexiunea
+*/
+static void removeClient(server_state *server, int fd) {
+    pthread_mutex_lock(&server->clients_lock);
+    for (int i = 0; i < server->noClients; i++) {
+        if (server->clients[i] == fd) {
+            server->clients[i] = server->clients[--server->noClients];
+            break;
+        }
+    }
+    pthread_cond_signal(&server->clients_cond);
+    pthread_mutex_unlock(&server->clients_lock);
+}
+
+/* @brief Thread-ul unei conexiuni: o serveste, apoi o scoate din lista conexiunilor deschise
+ * @param arg conexiunea (client_connection), eliberata la sfarsit
+*/
+static void *clientThread(void *arg) {
+    client_connection *conn = (client_connection *)arg;
+    server_state *server = conn->server;
+
+    handleClient(server, conn->fd);
+    removeClient(server, conn->fd);
+    free(conn);
+    return NULL;
+}
+
+/* @brief Porneste thread-ul unei conexiuni noi. Semnalele de oprire raman la thread-ul care
+ * accepta conexiuni, ca accept sa fie intrerupt.
+ * @param server starea serverului
+ * @param fd conexiunea
+ * @return 0 la succes, -1 daca sunt deja CLIENTS_MAX conexiuni sau thread-ul nu a putut fi creat
+*/
+static int startClient(server_state *server, int fd) {
+    struct timeval timeout = { CLIENT_TIMEOUT, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    client_connection *conn = (client_connection *)malloc(sizeof(client_connection));
+    if (!conn) {
+        return -1;
+    }
+    conn->server = server;
+    conn->fd = fd;
+
+    pthread_mutex_lock(&server->clients_lock);
+    if (server->noClients == CLIENTS_MAX) {
+        pthread_mutex_unlock(&server->clients_lock);
+        free(conn);
+        return -1;
+    }
+    server->clients[server->noClients++] = fd;
+    pthread_mutex_unlock(&server->clients_lock);
+
+    sigset_t block, old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    sigaddset(&block, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+
+    pthread_t tid;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int err = pthread_create(&tid, &attr, clientThread, conn);
+    pthread_attr_destroy(&attr);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (err) {
+        removeClient(server, fd);
+        free(conn);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* @brief Inchide citirea pe conexiunile deschise si asteapta terminarea thread-urilor lor
+ * @param server starea serverului
+*/
+static void stopClients(server_state *server) {
+    pthread_mutex_lock(&server->clients_lock);
+    for (int i = 0; i < server->noClients; i++) {
+        shutdown(server->clients[i], SHUT_RD);
+    }
+    while (server->noClients) {
+        pthread_cond_wait(&server->clients_cond, &server->clients_lock);
+    }
+    pthread_mutex_unlock(&server->clients_lock);
+}
+
+/* @brief Porneste serverul: thread-urile si contururile sunt pregatite o singura data, apoi
+ * fiecare conexiune este servita de un thread propriu, pana la SIGINT / SIGTERM. Job-urile
+ * ruleaza pe rand pe contextul comun.
+ * @param socket_path calea socket-ului Unix
+ * @param P numarul de thread-uri
+ * @param profile profilul masinii, daca P a fost ales automat, altfel NULL
+ * @return 0 la oprire normala, 1 la eroare
+*/
+int serve(const char *socket_path, int P, const marching_profile *profile) {
+    struct sockaddr_un addr;
+
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long '%s'\n", socket_path);
+        return 1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onSignal;
+    // fara SA_RESTART, ca accept sa fie intrerupt la oprire
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    int server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server_fd < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+
+    // un socket ramas de la o rulare anterioara
+    unlink(socket_path);
+
+    if (bind(server_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(server_fd, 16) < 0) {
+        perror(socket_path);
+        close(server_fd);
+        return 1;
+    }
+
+    server_state server;
+    memset(&server, 0, sizeof(server));
+    server.profile = profile;
+    int err = marching_create(&server.ctx, P, "./contours");
+    if (err) {
+        fprintf(stderr, "Unable to load contours: %s\n", marching_strerror(err));
+        close(server_fd);
+        unlink(socket_path);
+        return 1;
+    }
+    pthread_mutex_init(&server.job_lock, NULL);
+    pthread_mutex_init(&server.clients_lock, NULL);
+    pthread_cond_init(&server.clients_cond, NULL);
+
+    fprintf(stderr, "Listening on '%s' with %d threads\n", socket_path, P);
+
+    while (!stop_requested) {
+        int client_fd = accept(server_fd, NULL, NULL);
+        if (client_fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("accept");
+            break;
+        }
+
+        if (startClient(&server, client_fd)) {
+            static const char busy[] = "ERR Too many connections\n";
+            if (write(client_fd, busy, sizeof(busy) - 1) < 0) {
+                perror("write");
+            }
+            close(client_fd);
+        }
+    }
+
+    close(server_fd);
+    unlink(socket_path);
+    stopClients(&server);
+    pthread_cond_destroy(&server.clients_cond);
+    pthread_mutex_destroy(&server.clients_lock);
+    pthread_mutex_destroy(&server.job_lock);
+    marching_destroy(server.ctx);
+
+    return 0;
+}
@@ -0,0 +1,18 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "marching.h"
+
+// Protocolul de pe socket: clientul trimite o linie
+//     <in_file|-> <out_file|-> [optiuni]\n
+// Daca in_file este "-", imaginea PPM (P6) urmeaza imediat dupa linie.
+// Serverul raspunde cu "OK <n>\n" urmat de n octeti (imaginea PPM, doar daca out_file este "-")
+// sau cu "ERR <mesaj>\n". Cu --checksum raspunsul este "OK <n> <suma>\n", cu suma de control a
+// imaginii de iesire in hexazecimal; cu --checksum-only imaginea nu este scrisa, iar n este 0.
+// Un client poate trimite mai multe job-uri pe aceeasi conexiune. Conexiunile sunt servite in
+// paralel; o conexiune inactiva CLIENT_TIMEOUT secunde (sau o imagine trimisa incomplet) este
+// inchisa. Clientul inchide scrierea (shutdown) dupa ultima cerere.
+
+int serve(const char *socket_path, int P, const marching_profile *profile);
+
+#endif
@@ -0,0 +1,284 @@
+#include "marching_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+// Modul cu mai multe procese: imaginea de iesire este impartita in K benzi orizontale
+// (linii de celule), iar fiecare banda este calculata de un proces copil creat cu fork.
+// Imaginea de iesire este in memorie partajata POSIX; imaginea de intrare si contururile
+// sunt mostenite la fork si doar citite, deci nu sunt copiate. Fiecare proces scaleaza
+// liniile benzii sale, calculeaza punctele din grid ale benzii plus linia de dupa ea (halo)
+// direct din imaginea de intrare si marcheaza celulele benzii, fara sa astepte celelalte
+// procese. La sfarsit trimite o linie de stare pe un pipe; o banda al carei proces nu a
+// raspuns cu succes este recalculata o singura data de un proces nou.
+
+#define SHARD_MAX_PROCESSES     256
+#define SHARD_STATUS_SIZE       64
+
+typedef struct {
+    const ppm_image *in;
+    ppm_image *out;
+    ppm_image **contur;
+    int uniform[CONTOUR_CONFIG_COUNT];
+    int rescale;
+    int resample;
+    int K;
+    int p, q;
+} shard_job;
+
+/* @brief Creeaza o zona de memorie partajata. Numele este sters imediat, procesele copil
+ * mostenesc maparea, deci zona dispare odata cu ultimul proces care o foloseste.
+ * @param size dimensiunea zonei
+ * @return adresa zonei sau NULL la eroare
+*/
+static void *mapShared(size_t size) {
+    char name[64];
+    // adresa buffer-ului deosebeste apelurile simultane din acelasi proces
+    snprintf(name, sizeof(name), "/marching-%d-%p", (int)getpid(), (void *)name);
+
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        return NULL;
+    }
+    shm_unlink(name);
+
+    if (ftruncate(fd, size)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    return addr == MAP_FAILED ? NULL : addr;
+}
+
+/* @brief Citeste contururile 0.ppm ... 15.ppm
+ * @param contours_dir directorul cu contururi
+ * @param contur contururile citite (elementele neinitializate sunt NULL)
+ * @return MARCHING_OK sau un cod de eroare
+*/
+static int loadContours(const char *contours_dir, ppm_image **contur) {
+    for (int i = 0; i < CONTOUR_CONFIG_COUNT; i++) {
+        char filename[PATH_MAX_SIZE];
+        snprintf(filename, sizeof(filename), "%s/%d.ppm", contours_dir, i);
+
+        contur[i] = (ppm_image *)calloc(1, sizeof(ppm_image));
+        if (!contur[i]) {
+            return MARCHING_ERR_NOMEM;
+        }
+
+        int err = marching_load_ppm(filename, contur[i]);
+        if (err) {
+            return err;
+        }
+    }
+
+    return MARCHING_OK;
+}
+
+/* @brief Calculeaza o banda in procesul copil
+ * @param job job-ul
+ * @param band indexul benzii
+ * @return 0 la succes, -1 daca nu exista memorie
+*/
+static int runBand(const shard_job *job, int band) {
+    ppm_image *out = job->out;
+    int start = band * (double)job->p / job->K;
+    int end = min((band + 1) * (double)job->p / job->K, job->p);
+
+    // liniile de pixeli ale benzii; ultima banda contine si liniile de dupa ultima celula
+    int row_start = start * STEP;
+    int row_end = band == job->K - 1 ? out->x : end * STEP;
+
+    // doar liniile start ... end ale grid-ului sunt alocate
+    unsigned char **grid = (unsigned char **)malloc((job->p + 1) * sizeof(unsigned char *));
+    unsigned char *block = (unsigned char *)malloc((size_t)(end - start + 1) * (job->q + 1));
+    if (!grid || !block) {
+        free(grid);
+        free(block);
+        return -1;
+    }
+
+    for (int i = start; i <= end; i++) {
+        grid[i] = block + (size_t)(i - start) * (job->q + 1);
+        for (int j = 0; j <= job->q; j++) {
+            grid[i][j] = marching_grid_point(job->in, job->resample, out->x, out->y, i, j);
+        }
+    }
+
+    if (job->rescale) {
+        marching_rescale_rows(job->in, NULL, job->resample, out, row_start, row_end);
+    } else {
+        memcpy(&out->data[(size_t)row_start * out->y], &job->in->data[(size_t)row_start * out->y],
+               (size_t)(row_end - row_start) * out->y * sizeof(ppm_pixel));
+    }
+
+    marching_march_cells(out, job->contur, job->uniform, grid, STEP, STEP, start, end, 0, job->q);
+
+    free(grid);
+    free(block);
+    return 0;
+}
+
+/* @brief Porneste procesul care calculeaza o banda
+ * @param job job-ul
+ * @param band indexul benzii
+ * @param pids procesele benzilor
+ * @param fds capetele de citire ale pipe-urilor benzilor (-1 pentru cele inchise)
+ * @return 0 la succes, -1 la eroare
+*/
+static int startWorker(const shard_job *job, int band, pid_t *pids, int *fds) {
+    int pipefd[2];
+    if (pipe(pipefd)) {
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(pipefd[0]);
+        close(pipefd[1]);
+        return -1;
+    }
+
+    if (!pid) {
+        close(pipefd[0]);
+        for (int i = 0; i < job->K; i++) {
+            if (fds[i] >= 0) {
+                close(fds[i]);
+            }
+        }
+
+        char status[SHARD_STATUS_SIZE];
+        int ok = !runBand(job, band);
+        int len = snprintf(status, sizeof(status), ok ? "OK %d\n" : "ERR %d\n", band);
+        ok = write(pipefd[1], status, len) == len && ok;
+        _exit(ok ? 0 : 1);
+    }
+
+    close(pipefd[1]);
+    pids[band] = pid;
+    fds[band] = pipefd[0];
+    return 0;
+}
+
+/* @brief Asteapta procesul unei benzi si citeste linia de stare trimisa de el
+ * @param pid procesul
+ * @param fd capatul de citire al pipe-ului; este inchis si pus pe -1
+ * @return 0 daca banda a fost calculata, -1 altfel
+*/
+static int waitWorker(pid_t pid, int *fd) {
+    int wstatus;
+    char status[SHARD_STATUS_SIZE];
+
+    ssize_t len = read(*fd, status, sizeof(status) - 1);
+    close(*fd);
+    *fd = -1;
+
+    while (waitpid(pid, &wstatus, 0) < 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+
+    if (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus) || len < 3 || strncmp(status, "OK ", 3)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* @brief Ruleaza algoritmul in K procese, fiecare pe o banda orizontala a imaginii de iesire
+ * @param contours_dir directorul cu contururile (NULL inseamna ./contours)
+ * @param in imaginea de intrare; nu este modificata
+ * @param out imaginea de iesire, alocata de apelant cu dimensiunea data de marching_output_size
+ * @param K numarul de procese
+ * @param resample nucleul de esantionare pentru scalare (MARCHING_RESAMPLE_*)
+ * @return MARCHING_OK sau un cod de eroare
+*/
+int marching_squares_sharded(const char *contours_dir, const ppm_image *in, ppm_image *out, int K, int resample) {
+    int x, y;
+
+    if (!out || !out->data || !in || !in->data || marching_output_size(in, &x, &y)) {
+        return MARCHING_ERR_ARGS;
+    }
+    if (out->x != x || out->y != y || K <= 0 || K > SHARD_MAX_PROCESSES || resample < 0 ||
+        resample >= MARCHING_RESAMPLE_COUNT) {
+        return MARCHING_ERR_ARGS;
+    }
+
+    shard_job job;
+    ppm_image shared = { out->x, out->y, NULL };
+    size_t size = (size_t)out->x * out->y * sizeof(ppm_pixel);
+
+    job.in = in;
+    job.out = &shared;
+    job.rescale = !(in->x <= RESCALE_X && in->y <= RESCALE_Y);
+    job.resample = resample;
+    job.p = out->x / STEP;
+    job.q = out->y / STEP;
+    // nu are sens sa existe mai multe benzi decat linii de celule
+    job.K = min(K, job.p > 0 ? job.p : 1);
+
+    ppm_image *contur[CONTOUR_CONFIG_COUNT] = { NULL };
+    job.contur = contur;
+    int err = loadContours(contours_dir ? contours_dir : "./contours", contur);
+    if (!err) {
+        marching_find_uniform_contours(contur, job.uniform);
+
+        shared.data = (ppm_pixel *)mapShared(size);
+        if (!shared.data) {
+            err = MARCHING_ERR_NOMEM;
+        }
+    }
+
+    pid_t pids[SHARD_MAX_PROCESSES];
+    int fds[SHARD_MAX_PROCESSES];
+    int started = 0;
+
+    for (int i = 0; i < job.K; i++) {
+        fds[i] = -1;
+    }
+
+    for (; !err && started < job.K; started++) {
+        if (startWorker(&job, started, pids, fds)) {
+            err = MARCHING_ERR_WORKER;
+            break;
+        }
+    }
+
+    // astept toate procesele pornite, chiar daca o banda a esuat; o banda este recalculata
+    // o singura data, iar rezultatul unui proces oprit la jumatate este suprascris
+    for (int i = 0; i < started; i++) {
+        int attempts = 1;
+
+        while (waitWorker(pids[i], &fds[i])) {
+            if (err || attempts == 2 || startWorker(&job, i, pids, fds)) {
+                err = MARCHING_ERR_WORKER;
+                break;
+            }
+            attempts++;
+        }
+    }
+
+    if (!err) {
+        memcpy(out->data, shared.data, size);
+    }
+
+    if (shared.data) {
+        munmap(shared.data, size);
+    }
+    for (int i = 0; i < CONTOUR_CONFIG_COUNT; i++) {
+        if (contur[i]) {
+            free(contur[i]->data);
+            free(contur[i]);
+        }
+    }
+
+    return err;
+}
@@ -0,0 +1,138 @@
+// Client pentru modul --serve al tema1_par. Trimite un job si asteapta raspunsul.
+// Protocolul este descris in server.h.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define REQUEST_MAX_SIZE        4096
+#define COPY_BUFFER_SIZE        65536
+
+/* @brief Copiaza cel mult limit octeti dintr-un stream in altul (limit < 0 inseamna pana la EOF)
+ * @param in stream-ul sursa
+ * @param out stream-ul destinatie
+ * @param limit numarul de octeti
+ * @return numarul de octeti copiati
+*/
+long long copyStream(FILE *in, FILE *out, long long limit) {
+    char buff[COPY_BUFFER_SIZE];
+    long long total = 0;
+
+    while (limit < 0 || total < limit) {
+        size_t chunk = sizeof(buff);
+        if (limit >= 0 && (long long)chunk > limit - total) {
+            chunk = limit - total;
+        }
+
+        size_t n = fread(buff, 1, chunk, in);
+        if (n == 0) {
+            break;
+        }
+        if (fwrite(buff, 1, n, out) != n) {
+            break;
+        }
+        total += n;
+    }
+
+    return total;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 4) {
+        fprintf(stderr, "Usage: ./tema1_client <socket> <in_file|-> <out_file|-> [options]\n");
+        return 1;
+    }
+
+    // caile sunt trimise absolute, deoarece serverul poate rula in alt director
+    char in_path[PATH_MAX], out_path[PATH_MAX];
+    if (strcmp(argv[2], "-") && !realpath(argv[2], in_path)) {
+        perror(argv[2]);
+        return 1;
+    }
+    if (!strcmp(argv[2], "-")) {
+        strcpy(in_path, "-");
+    }
+
+    if (!strcmp(argv[3], "-") || argv[3][0] == '/') {
+        snprintf(out_path, sizeof(out_path), "%s", argv[3]);
+    } else {
+        char cwd[PATH_MAX];
+        if (!getcwd(cwd, sizeof(cwd))) {
+            perror("getcwd");
+            return 1;
+        }
+        if (snprintf(out_path, sizeof(out_path), "%s/%s", cwd, argv[3]) >= (int)sizeof(out_path)) {
+            fprintf(stderr, "Path too long '%s'\n", argv[3]);
+            return 1;
+        }
+    }
+
+    char request[REQUEST_MAX_SIZE];
+    int size = snprintf(request, sizeof(request), "%s %s", in_path, out_path);
+    for (int i = 4; i < argc && size < (int)sizeof(request); i++) {
+        size += snprintf(request + size, sizeof(request) - size, " %s", argv[i]);
+    }
+    if (size >= (int)sizeof(request) - 1) {
+        fprintf(stderr, "Request too long\n");
+        return 1;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", argv[1]);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    FILE *in = fdopen(fd, "rb");
+    FILE *out = fdopen(dup(fd), "wb");
+    if (!in || !out) {
+        perror("fdopen");
+        return 1;
+    }
+
+    fprintf(out, "%s\n", request);
+    if (!strcmp(in_path, "-")) {
+        copyStream(stdin, out, -1);
+    }
+    fflush(out);
+    // serverul vede sfarsitul cererii, chiar daca imaginea trimisa este incompleta
+    shutdown(fd, SHUT_WR);
+
+    char response[REQUEST_MAX_SIZE];
+    if (!fgets(response, sizeof(response), in)) {
+        fprintf(stderr, "Connection closed by server\n");
+        return 1;
+    }
+
+    long long n;
+    char checksum[17];
+    int fields = sscanf(response, "OK %lld %16s", &n, checksum);
+    if (fields < 1) {
+        fprintf(stderr, "%s", response);
+        return 1;
+    }
+
+    if (n > 0 && copyStream(in, stdout, n) != n) {
+        fprintf(stderr, "Truncated response\n");
+        return 1;
+    }
+
+    // suma de control ajunge la stdout, ca la tema1_par, daca imaginea nu a fost trimisa tot acolo
+    if (fields == 2) {
+        fprintf(n > 0 ? stderr : stdout, "%s\n", checksum);
+    }
+
+    fclose(in);
+    fclose(out);
+
+    return 0;
+}
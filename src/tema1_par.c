@@ -1,345 +1,182 @@
 // Author: APD team, except where source was noted
 
 #include "helpers.h"
+#include "marching.h"
+#include "options.h"
+#include "server.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
-#include <pthread.h>
 
-#define CONTOUR_CONFIG_COUNT    16
-#define FILENAME_MAX_SIZE       50
-#define STEP                    8
-#define SIGMA                   200
-#define RESCALE_X               2048
-#define RESCALE_Y               2048
-
-#define CLAMP(v, min, max) if(v < min) { v = min; } else if(v > max) { v = max; }
-
-typedef struct thread {
-    int noThreads;
-    int id;
-    unsigned char **grid;
-
-    ppm_image **contur;
-    ppm_image *image;
-    ppm_image *scaled_image;
-
-    pthread_barrier_t *barrier;
-} thread_structure;
-
-/*@brief Returneaza minimul dintre doua numere
- * @param a primul numar
- * @param b al doilea numar
- * @return minimul dintre a si b
-*/
-int min(int a, int b) {
-    return a < b ? a:b;
-}
-
-// Updates a particular section of an image with the corresponding contour pixels.
-// Used to create the complete contour image.
-/* @brief Actualizeaza o anumita sectiune a imaginii cu pixelii corespunzatori conturului
- * @param image imaginea
- * @param contour conturul
- * @param x coordonata x
- * @param y coordonata y
-*/
-void update_image(ppm_image *image, ppm_image *contour, int x, int y) {  
-    for (int i = 0; i < contour->x; i++) {
-        for (int j = 0; j < contour->y; j++) {
-            int contour_pixel_index = contour->x * i + j;
-            int image_pixel_index = (x + i) * image->y + y + j;
-
-            image->data[image_pixel_index].red = contour->data[contour_pixel_index].red;
-            image->data[image_pixel_index].green = contour->data[contour_pixel_index].green;
-            image->data[image_pixel_index].blue = contour->data[contour_pixel_index].blue;
-        }
-    }
-}
-
-/*@brief Elibereaza memoria. Este nevoie doar de vectorul de thread-uri deoarece imaginile sunt salvate in interior
- * si toate thread-urile au pointer spre aceeasi imagine(scalata, normala, grid etc.)
- * @param threads vectorul de thread-uri
- * @param step_x pasul pe axa x
+/* @brief Elibereaza maparea imaginii de intrare (marching_options.release_input, cu --low-memory)
+ * @param arg maparea
 */
-void freeResources(thread_structure **threads, int step_x) {
-    for (int i = 0; i < CONTOUR_CONFIG_COUNT; ++i) {
-        free(threads[0]->contur[i]->data);
-        free(threads[0]->contur[i]);
-    }
-    free(threads[0]->contur);
-
-    // Toate thread-urile au acceasi imagine. E safe sa folosesc threads[0] deoarece, in cazul in care este un singur thread
-    // voi avea cv inauntru garantat
-    for(int i = 0; i <= threads[0]->image->x / step_x; ++i) {
-        free(threads[0]->grid[i]);
-    }
-    free(threads[0]->grid);
-
-    free(threads[0]->image->data);
-    free(threads[0]->image);
-
-    if(threads[0]->image != threads[0]->scaled_image) {
-        free(threads[0]->scaled_image->data);
-        free(threads[0]->scaled_image);
-    }
-
-    int P = threads[0]->noThreads;
-    for(int i = 0; i < P; ++i) {
-        free(threads[i]);
-    }
-    free(threads);
+static void unmapImage(void *arg) {
+    marching_unmap_ppm((ppm_mapping *)arg);
 }
 
-/*@brief Citeste contururile din directorul ./contours
- * @param informatii utile folosite de thread-ul curent
-*/
-void contur(thread_structure *thread) {
-    int start = thread->id * (double)CONTOUR_CONFIG_COUNT / thread->noThreads;
-    int end = min((thread->id + 1) * (double)CONTOUR_CONFIG_COUNT / thread->noThreads, CONTOUR_CONFIG_COUNT);
-
-    for (int i = start; i < end; i++) {
-        char filename[FILENAME_MAX_SIZE];
-        sprintf(filename, "./contours/%d.ppm", i);
-        thread->contur[i] = read_ppm(filename);
-    }
-}
-
-/* @brief Scaleaza imaginea folosind interpolare bicubica
- * @param thread informatii utile folosite de thread-ul curent
-*/
-void rescaleImage(thread_structure *thread) {
-    uint8_t sample[3];
-
-    // Se imparte imaginea in functie de numarul de thread-uri si de thread-ul care ruleaza
-    int start = thread->id * (double)thread->scaled_image->x / thread->noThreads;
-    int end = min((thread->id + 1) * (double)thread->scaled_image->x / thread->noThreads, thread->scaled_image->x);
-
-    // use bicubic interpolation for scaling
-    for (int i = start; i < end; i++) {
-        for (int j = 0; j < thread->scaled_image->y; j++) {
-            float u = (float)i / (float)(thread->scaled_image->x - 1);
-            float v = (float)j / (float)(thread->scaled_image->y - 1);
-            sample_bicubic(thread->image, u, v, sample);
+int main(int argc, char *argv[]) {
+    int P;
 
-            thread->scaled_image->data[i * thread->scaled_image->y + j].red = sample[0];
-            thread->scaled_image->data[i * thread->scaled_image->y + j].green = sample[1];
-            thread->scaled_image->data[i * thread->scaled_image->y + j].blue = sample[2];
+    if (argc == 4 && !strcmp(argv[1], "--serve")) {
+        if (parseThreads(argv[3], &P)) {
+            fprintf(stderr, "P must be a positive number or 'auto'\n");
+            return -1;
         }
-    }
-}
-
-/* @brief Creeaza grid-ul
- * @param thread informatii utile folosite de thread-ul curent
- * @param step_x pasul pe axa x
- * @param step_y pasul pe axa y
- * @param sigma valoarea de prag
- * @param p numarul de linii
- * @param q numarul de coloane
-*/
-void createGrid(thread_structure *thread, int step_x, int step_y, int sigma, int p, int q) {
-
-    // se imparte imaginea in functie de numarul de thread-uri si de thread-ul care ruleaza
-    int start = thread->id * (double)q / thread->noThreads;
-    int end = min((thread->id + 1) * (double)p / thread->noThreads, p);
 
-    for (int i = start; i < end; i++) {
-        for (int j = 0; j < q; j++) {
-            ppm_pixel curr_pixel = thread->image->data[i * step_x * thread->image->y + j * step_y];
-
-            unsigned char curr_color = (curr_pixel.red + curr_pixel.green + curr_pixel.blue) / 3;
-
-            if (curr_color > sigma) {
-                thread->grid[i][j] = 0;
-            } else {
-                thread->grid[i][j] = 1;
+        // serverul pastreaza acelasi context pentru toate imaginile, deci cu "auto" numarul de
+        // thread-uri este cel ales de profil pentru cel mai mare job (o imagine scalata); bucatile
+        // de scalare sunt alese apoi pentru fiecare imagine
+        if (P == THREADS_AUTO) {
+            char path[4096];
+            marching_profile profile;
+            ppm_image largest = { RESCALE_X + 1, RESCALE_Y + 1, NULL };
+            int chunk;
+
+            profilePath(path, sizeof(path));
+            int err = marching_profile_load(path, "./contours", &profile);
+            if (err) {
+                fprintf(stderr, "Unable to calibrate: %s\n", marching_strerror(err));
+                return 1;
             }
-        }
-    }
-
-    // last sample points have no neighbors below / to the right, so we use pixels on the
-    // last row / column of the input image for them
-    for (int i = start; i < end; i++) {
-        ppm_pixel curr_pixel = thread->image->data[i * step_x * thread->image->y + thread->image->x - 1];
-
-        unsigned char curr_color = (curr_pixel.red + curr_pixel.green + curr_pixel.blue) / 3;
 
-        if (curr_color > sigma) {
-            thread->grid[i][q] = 0;
-        } else {
-            thread->grid[i][q] = 1;
+            marching_autotune(&profile, &largest, &P, &chunk);
+            return serve(argv[2], P, &profile);
         }
-    }
-
-    // schimb start si stop pentru a paraleliza si forul de mai jos
-    start = thread->id * (double)q / thread->noThreads;
-    end = min((thread->id + 1) * (double)q / thread->noThreads, q);
-
-    for (int j = start; j < end; j++) {
-        ppm_pixel curr_pixel = thread->image->data[(thread->image->x - 1) * thread->image->y + j * step_y];
-
-        unsigned char curr_color = (curr_pixel.red + curr_pixel.green + curr_pixel.blue) / 3;
 
-        if (curr_color > sigma) {
-            thread->grid[p][j] = 0;
-        } else {
-            thread->grid[p][j] = 1;
-        }
+        return serve(argv[2], P, NULL);
     }
-}
 
-/* @brief Marcheaza conturul
- * @param thread informatii utile folosite de thread-ul curent
- * @param step_x pasul pe axa x
- * @param step_y pasul pe axa y
- * @param p numarul de linii
- * @param q numarul de coloane
-*/
-void march(thread_structure *thread, int step_x, int step_y, int p, int q) {
-    int start = thread->id * (double)q / thread->noThreads;
-    int end = min((thread->id + 1) * (double)q / thread->noThreads, q);
-    for (int i = 0; i < p; i++) {
-        for (int j = start; j < end; j++) {
-            unsigned char k = 8 * thread->grid[i][j] + 4 * thread->grid[i][j + 1] + 2 * thread->grid[i + 1][j + 1] + 1 * thread->grid[i + 1][j];
-            update_image(thread->image, thread->contur[k], i * step_x, j * step_y);
-        }
+    if (argc < 4) {
+        fprintf(stderr, "Usage: ./tema1 <in_file> <out_file> <P|auto> [--tiled] [--pyramid] [--pipeline] [--roi|--roi-input <x,y,w,h>] [--processes <K>] [--cache-dir <dir>] [--cache-size <MB>] [--low-memory] [--rescale-chunk <rows>] [--resample bicubic|bilinear|nearest|area] [--checksum|--checksum-only] [--stats] [--perf-counters] [--trace <file.json>]\n");
+        fprintf(stderr, "       ./tema1 --serve <socket> <P|auto>\n");
+        return 1;
     }
-}
-
-/* @brief Functia executata de fiecare thread
- * @param arg informatii utile folosite de thread-ul curent
-*/
-void *thread_function(void *arg) {
-    thread_structure *thread = (thread_structure *)arg;
-
-    contur(thread);
-    pthread_barrier_wait(thread->barrier);
 
-    // Se da rescale doar daca imaginea este mai mare decat cea dorita
-    if (!(thread->image->x <= RESCALE_X && thread->image->y <= RESCALE_Y)) {
-        rescaleImage(thread);
-        pthread_barrier_wait(thread->barrier);
+    marching_options opts;
+    if (parseOptions(argc, argv, 4, &opts)) {
+        return 1;
     }
 
-    // in cazul in care nu intra pe if, nu se va schimba nimic.
-    // Chiar daca toate thread-urile schimba valoarea nu este problema deoarece este aceeasi adresa la toate
-    // Toate thread-urile au lucrat pe aceeasi zona de memorie
-    thread->image = thread->scaled_image;
-
-    int step_x = STEP;
-    int step_y = STEP;
-
-    int p = thread->image->x / step_x;
-    int q = thread->image->y / step_y;
-    int sigma = SIGMA;
-
-    createGrid(thread, step_x, step_y, sigma, p, q);
-
-    pthread_barrier_wait(thread->barrier);
-
-    march(thread, step_x, step_y, p, q);
-
-    return NULL;
-}
-
-int main(int argc, char *argv[]) {
-    if (argc < 4) {
-        fprintf(stderr, "Usage: ./tema1 <in_file> <out_file> <P>\n");
+    const char *invalid = checkOptions(&opts);
+    if (invalid) {
+        fprintf(stderr, "%s\n", invalid);
         return 1;
     }
 
-    if(atoi(argv[3]) <= 0) {
-        fprintf(stderr, "P must be a positive number\n");
+    if (parseThreads(argv[3], &P)) {
+        fprintf(stderr, "P must be a positive number or 'auto'\n");
         return -1;
     }
 
-    ppm_image *image = read_ppm(argv[1]);
-    // usless mai departe
-    int step_x = STEP;
-    int step_y = STEP;
-
-    int P = argv[3][0] - 48;
-    pthread_t tid[P];
-    // int thread_id[P];
-    thread_structure **threads = calloc(P, sizeof(thread_structure));
+    // cu --low-memory imaginea de intrare este mapata din fisier, iar maparea este eliberata
+    // imediat ce job-ul nu mai citeste din ea
+    ppm_image image, result;
+    ppm_mapping mapping = { { 0, 0, NULL }, NULL, 0 };
+    int err;
+    if (opts.low_memory) {
+        err = marching_map_ppm(argv[1], &mapping);
+        image = mapping.image;
+    } else {
+        err = marching_load_ppm(argv[1], &image);
+    }
+    if (err) {
+        fprintf(stderr, "Error loading image '%s': %s\n", argv[1], marching_strerror(err));
+        return 1;
+    }
 
-    // initilzez conturul
-    ppm_image **map = (ppm_image **)malloc(CONTOUR_CONFIG_COUNT * sizeof(ppm_image *));
-    if (!map) {
+    if (marching_result_size(&image, &opts, &result.x, &result.y)) {
+        fprintf(stderr, "Invalid region of interest\n");
+        return 1;
+    }
+    result.data = (ppm_pixel *)malloc((size_t)result.x * result.y * sizeof(ppm_pixel));
+    if (!result.data) {
         fprintf(stderr, "Unable to allocate memory\n");
-        exit(1);
+        return 1;
     }
 
-    // create barrier
-    pthread_barrier_t barrier;
-    pthread_barrier_init(&barrier, NULL, P);
+    // cu alt nucleu decat cel bicubic, --stats arata cate celule si-au schimbat cazul; punctele
+    // din grid se calculeaza din imaginea de intrare, deci inainte ca job-ul sa o elibereze
+    if (opts.stats && opts.resample != MARCHING_RESAMPLE_BICUBIC) {
+        uint64_t changed, cells;
 
-    // alloc space for new scaled image
-    ppm_image *new_image;
-    if(!(image->x <= RESCALE_X && image->y <= RESCALE_Y)) { // only use memory if needed
-        new_image = (ppm_image *)malloc(sizeof(ppm_image));
-        if (!new_image) {
-            fprintf(stderr, "Unable to allocate memory\n");
-            exit(1);
+        err = marching_resample_diff(&image, opts.resample, opts.pyramid, &changed, &cells);
+        if (err) {
+            fprintf(stderr, "Unable to compare resampling kernels: %s\n", marching_strerror(err));
+        } else {
+            fprintf(stderr, "resample %s: %llu of %llu cells (%.3f%%) change case compared with bicubic\n",
+                    resampleName(opts.resample), (unsigned long long)changed, (unsigned long long)cells,
+                    cells ? 100.0 * changed / cells : 0.0);
         }
-        new_image->x = RESCALE_X;
-        new_image->y = RESCALE_Y;
+    }
 
-        new_image->data = (ppm_pixel*)malloc(new_image->x * new_image->y * sizeof(ppm_pixel));
-        if (!new_image) {
-            fprintf(stderr, "Unable to allocate memory\n");
-            exit(1);
+    // cu --processes, banda fiecarui proces este calculata fara thread-urile unui context
+    marching_context *ctx = NULL;
+    uint64_t checksum = 0;
+    if (opts.processes) {
+        err = marching_squares_sharded("./contours", &image, &result, opts.processes, opts.resample);
+        if (!err && opts.checksum) {
+            err = marching_image_checksum(&result, &checksum);
         }
     } else {
-        new_image = image;
-    }
+        // cu "auto", P si bucatile de scalare sunt alese dupa dimensiunea imaginii si profilul masinii
+        if (P == THREADS_AUTO) {
+            char path[4096];
+            marching_profile profile;
+
+            profilePath(path, sizeof(path));
+            err = marching_profile_load(path, "./contours", &profile);
+            if (err) {
+                fprintf(stderr, "Unable to calibrate: %s\n", marching_strerror(err));
+                return 1;
+            }
 
-    // alocate memory for grid
-    int p = image->x / step_x;
-    int q = image->y / step_y;
+            marching_autotune(&profile, &image, &P, &opts.rescale_chunk);
+            if (opts.stats) {
+                fprintf(stderr, "auto: %d threads, rescale chunk %d rows (profile '%s')\n", P, opts.rescale_chunk, path);
+            }
+        }
 
-    // aloc memorie pentru grid
-    unsigned char **grid = (unsigned char **)malloc((p + 1) * sizeof(unsigned char*));
-    if (!grid) {
-        fprintf(stderr, "Unable to allocate memory\n");
-        exit(1);
-    }
+        err = marching_create(&ctx, P, "./contours");
+        if (err) {
+            fprintf(stderr, "Unable to load contours: %s\n", marching_strerror(err));
+            return 1;
+        }
 
-    for (int i = 0; i <= p; i++) {
-        grid[i] = (unsigned char *)malloc((q + 1) * sizeof(unsigned char));
-        if (!grid[i]) {
-            fprintf(stderr, "Unable to allocate memory\n");
-            exit(1);
+        if (opts.low_memory) {
+            opts.release_input = unmapImage;
+            opts.release_arg = &mapping;
         }
-    }
 
-    // Creez thread-uri si le dau informatiile necesare
-    for(int i = 0; i < P; ++i) {
-        threads[i] = calloc(1, sizeof(thread_structure));
-        threads[i]->id = i;
-        threads[i]->noThreads = P;
-        threads[i]->contur = map;
-        threads[i]->image = image;
-        threads[i]->scaled_image = new_image;
-        threads[i]->grid = grid;
-        threads[i]->barrier = &barrier;
-        int thread = pthread_create(&(tid[i]), NULL, thread_function, threads[i]);
-        if (thread) {
-            printf("Error creating thread %d\n", i);
-            return 1;
+        err = marching_squares(ctx, &image, &result, &opts);
+        marching_print_stats(ctx, stderr);
+        if (!err && opts.checksum) {
+            err = marching_checksum(ctx, &checksum);
         }
     }
 
-    for(int i = 0; i < P; ++i) {
-        pthread_join(tid[i], NULL);
+    // suma de control se afiseaza la stdout, ca rezultatele sa poata fi comparate fara fisiere
+    if (!err && opts.checksum) {
+        printf("%016llx\n", (unsigned long long)checksum);
     }
 
-    pthread_barrier_destroy(&barrier);
-
-    write_ppm(threads[0]->scaled_image, argv[2]);
+    if (!err && !opts.no_output) {
+        err = marching_save_ppm(&result, argv[2]);
+        if (err) {
+            fprintf(stderr, "Error writing image '%s': %s\n", argv[2], marching_strerror(err));
+        }
+    } else if (err) {
+        fprintf(stderr, "Error processing image '%s': %s\n", argv[1], marching_strerror(err));
+    }
 
-    freeResources(threads, step_x);
+    if (opts.low_memory) {
+        marching_unmap_ppm(&mapping);
+    } else {
+        free(image.data);
+    }
+    free(result.data);
+    marching_destroy(ctx);
 
-    return 0;
+    return err ? 1 : 0;
 }
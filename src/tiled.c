@@ -0,0 +1,118 @@
+#include "tiled.h"
+#include "resample.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define CLAMP(v, min, max) if(v < min) { v = min; } else if(v > max) { v = max; }
+
+/* @brief Aloca o imagine impartita pe tile-uri, aliniata la pagina
+ * @param x latimea imaginii
+ * @param y inaltimea imaginii
+ * @return imaginea alocata (pixelii nu sunt initializati) sau NULL daca nu exista memorie
+*/
+tiled_image *marching_alloc_tiled(int x, int y) {
+    tiled_image *img = (tiled_image *)malloc(sizeof(tiled_image));
+    if (!img) {
+        return NULL;
+    }
+
+    img->x = x;
+    img->y = y;
+    img->tiles_x = (x + TILE_SIZE - 1) >> TILE_SHIFT;
+    img->tiles_y = (y + TILE_SIZE - 1) >> TILE_SHIFT;
+
+    // dimensiunea unui tile este multiplu de TILE_ALIGN, deci si dimensiunea totala
+    size_t size = (size_t)img->tiles_x * img->tiles_y * TILE_SIZE * TILE_SIZE * sizeof(ppm_pixel);
+    img->data = (ppm_pixel *)aligned_alloc(TILE_ALIGN, size);
+    if (!img->data) {
+        free(img);
+        return NULL;
+    }
+
+    return img;
+}
+
+/* @brief Elibereaza o imagine impartita pe tile-uri
+ * @param img imaginea
+*/
+void marching_free_tiled(tiled_image *img) {
+    if (!img) {
+        return;
+    }
+
+    free(img->data);
+    free(img);
+}
+
+/* @brief Copiaza liniile de tile-uri [start, end) din imaginea sursa in imaginea pe tile-uri.
+ * Sursa este citita secvential, linie cu linie.
+ * @param source imaginea sursa (row-major)
+ * @param dest imaginea destinatie
+ * @param start prima linie de tile-uri
+ * @param end linia de tile-uri de dupa ultima
+*/
+void marching_repack_tiles(const ppm_image *source, tiled_image *dest, int start, int end) {
+    for (int ty = start; ty < end; ty++) {
+        int last_y = ty * TILE_SIZE + TILE_SIZE;
+        if (last_y > source->y) {
+            last_y = source->y;
+        }
+
+        for (int y = ty * TILE_SIZE; y < last_y; y++) {
+            const ppm_pixel *row = &source->data[(size_t)source->x * y];
+
+            for (int tx = 0; tx < dest->tiles_x; tx++) {
+                int x = tx * TILE_SIZE;
+                int count = source->x - x < TILE_SIZE ? source->x - x : TILE_SIZE;
+
+                memcpy(tiled_pixel(dest, x, y), &row[x], count * sizeof(ppm_pixel));
+            }
+        }
+    }
+}
+
+// Acelasi calcul ca marching_sample_bicubic (resample.c), deci rezultatul este identic bit cu bit.
+// Difera doar accesul la pixeli, care trece prin tiled_pixel.
+void marching_sample_bicubic_tiled(tiled_image *source_image, float u, float v, uint8_t sample[]) {
+    float x = (u * source_image->x) - 0.5;
+    int xint = (int)x;
+    float xfract = x - floor(x);
+
+    float y = (v * source_image->y) - 0.5;
+    int yint = (int)y;
+    float yfract = y - floor(y);
+
+    // p[linie][coloana][canal]
+    uint8_t p[4][4][3];
+
+    for (int i = 0; i < 4; i++) {
+        int py = yint - 1 + i;
+        CLAMP(py, 0, source_image->y - 1);
+
+        for (int j = 0; j < 4; j++) {
+            int px = xint - 1 + j;
+            CLAMP(px, 0, source_image->x - 1);
+
+            ppm_pixel *pixel = tiled_pixel(source_image, px, py);
+            p[i][j][0] = pixel->red;
+            p[i][j][1] = pixel->green;
+            p[i][j][2] = pixel->blue;
+        }
+    }
+
+    // interpolate bi-cubically
+    for (int i = 0; i < 3; i++) {
+        float col[4];
+
+        for (int k = 0; k < 4; k++) {
+            col[k] = marching_cubic_hermite(p[k][0][i], p[k][1][i], p[k][2][i], p[k][3][i], xfract);
+        }
+
+        float value = marching_cubic_hermite(col[0], col[1], col[2], col[3], yfract);
+
+        CLAMP(value, 0.0f, 255.0f);
+
+        sample[i] = (uint8_t)value;
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef TILED_H
+#define TILED_H
+
+#include "helpers.h"
+
+// Imaginea sursa este impartita in tile-uri de 64x64 pixeli. Un tile ocupa
+// 64 * 64 * 3 = 12288 octeti, adica exact 3 pagini, iar buffer-ul este aliniat
+// la pagina, deci vecinatatea 4x4 a interpolarii bicubice atinge de obicei un
+// singur tile (si cateva pagini) in loc de 4 linii aflate la distanta mare.
+#define TILE_SHIFT      6
+#define TILE_SIZE       (1 << TILE_SHIFT)
+#define TILE_MASK       (TILE_SIZE - 1)
+#define TILE_ALIGN      4096
+
+typedef struct {
+    int x, y;
+    int tiles_x, tiles_y;
+    ppm_pixel *data;
+} tiled_image;
+
+tiled_image *marching_alloc_tiled(int x, int y);
+void marching_free_tiled(tiled_image *img);
+void marching_repack_tiles(const ppm_image *source, tiled_image *dest, int start, int end);
+void marching_sample_bicubic_tiled(tiled_image *source_image, float u, float v, uint8_t sample[]);
+
+/* @brief Intoarce pixelul (x, y) din imaginea impartita pe tile-uri
+ * @param img imaginea
+ * @param x coloana
+ * @param y linia
+*/
+static inline ppm_pixel *tiled_pixel(tiled_image *img, int x, int y) {
+    size_t tile = (size_t)(y >> TILE_SHIFT) * img->tiles_x + (x >> TILE_SHIFT);
+
+    return &img->data[(tile << (2 * TILE_SHIFT)) + ((y & TILE_MASK) << TILE_SHIFT) + (x & TILE_MASK)];
+}
+
+#endif
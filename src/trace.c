@@ -0,0 +1,93 @@
+#include "trace.h"
+#include <stdlib.h>
+#include <time.h>
+
+#define TRACE_INITIAL_CAPACITY  64
+
+/* @brief Timpul curent, in nanosecunde, pe ceasul monoton
+ * @return timpul curent
+*/
+uint64_t marching_trace_now(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+/* @brief Adauga un eveniment in buffer-ul unui thread. Daca nu mai exista memorie
+ * evenimentul este pierdut si numarat in dropped.
+ * @param tb buffer-ul
+ * @param name numele evenimentului (sir constant)
+ * @param kind TRACE_PHASE sau TRACE_WAIT
+ * @param start inceputul, in ns
+ * @param end sfarsitul, in ns
+ * @param chunk_start primul index lucrat (-1 daca nu exista un singur interval)
+ * @param chunk_end indexul de dupa ultimul lucrat
+*/
+void marching_trace_add(trace_buffer *tb, const char *name, int kind, uint64_t start, uint64_t end, int chunk_start, int chunk_end) {
+    if (tb->count == tb->capacity) {
+        int capacity = tb->capacity ? 2 * tb->capacity : TRACE_INITIAL_CAPACITY;
+        trace_event *events = realloc(tb->events, capacity * sizeof(trace_event));
+
+        if (!events) {
+            tb->dropped++;
+            return;
+        }
+        tb->events = events;
+        tb->capacity = capacity;
+    }
+
+    trace_event *ev = &tb->events[tb->count++];
+    ev->name = name;
+    ev->kind = kind;
+    ev->start = start;
+    ev->end = end;
+    ev->chunk_start = chunk_start;
+    ev->chunk_end = chunk_end;
+}
+
+/* @brief Scrie evenimentele tuturor thread-urilor ca JSON, in formatul Chrome Trace Event.
+ * Fiecare eveniment este de tip "X" (complet), cu timpul in microsecunde fata de origin.
+ * @param fp stream-ul
+ * @param buffers buffer-ele thread-urilor; indexul este tid-ul din trace
+ * @param count numarul de buffere
+ * @param origin momentul considerat 0, in ns
+ * @return 0 la succes, -1 la eroare de scriere
+*/
+int marching_trace_write(FILE *fp, trace_buffer *buffers[], int count, uint64_t origin) {
+    int first = 1;
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    for (int t = 0; t < count; t++) {
+        // evenimentele pierdute din lipsa de memorie apar in argumentele thread-ului
+        fprintf(fp, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"worker %d\",\"dropped\":%d}}",
+                first ? "" : ",", t, t, buffers[t]->dropped);
+        first = 0;
+
+        for (int i = 0; i < buffers[t]->count; i++) {
+            trace_event *ev = &buffers[t]->events[i];
+
+            fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                    ev->name, ev->kind == TRACE_WAIT ? "wait" : "phase", t,
+                    (ev->start - origin) / 1000.0, (ev->end - ev->start) / 1000.0);
+            if (ev->chunk_start >= 0) {
+                fprintf(fp, ",\"args\":{\"start\":%d,\"end\":%d}", ev->chunk_start, ev->chunk_end);
+            }
+            fprintf(fp, "}");
+        }
+    }
+
+    fprintf(fp, "\n]}\n");
+
+    return ferror(fp) ? -1 : 0;
+}
+
+/* @brief Elibereaza memoria unui buffer
+ * @param tb buffer-ul
+*/
+void marching_trace_free(trace_buffer *tb) {
+    free(tb->events);
+    tb->events = NULL;
+    tb->count = tb->capacity = 0;
+}
@@ -0,0 +1,32 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Evenimente pe thread, exportate in formatul Chrome Trace Event (Perfetto, chrome://tracing)
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Tipul unui eveniment: o faza lucrata sau o asteptare (bariera, planificatorul pipeline-ului)
+#define TRACE_PHASE             0
+#define TRACE_WAIT              1
+
+typedef struct {
+    const char *name;
+    int kind;
+    uint64_t start, end;
+    // intervalul de linii / coloane lucrat in faza (-1 daca nu exista)
+    int chunk_start, chunk_end;
+} trace_event;
+
+typedef struct {
+    trace_event *events;
+    int count, capacity;
+    int dropped;
+} trace_buffer;
+
+uint64_t marching_trace_now(void);
+void marching_trace_add(trace_buffer *tb, const char *name, int kind, uint64_t start, uint64_t end, int chunk_start, int chunk_end);
+int marching_trace_write(FILE *fp, trace_buffer *buffers[], int count, uint64_t origin);
+void marching_trace_free(trace_buffer *tb);
+
+#endif